@@ -1,8 +1,20 @@
 #!/bin/bash
+# Usage: ./compile.sh [--mpi-profile]
+# --mpi-profile links the PMPI profiling library (src/profiler), which prints MPI call statistics at MPI_Finalize.
 
 echo "Compiling Parallel Computation Project"
 
 mkdir -p output
 
+echo "Building MPI profiling library..."
+mpic++ -c -I./include src/profiler/mpi_profiler.cpp -o mpi_profiler.o && ar rcs libmpi_profiler.a mpi_profiler.o
+rm -f mpi_profiler.o
+
+PROFILER_LIB=""
+if [ "$1" == "--mpi-profile" ]; then
+    echo "Linking the MPI profiling library"
+    PROFILER_LIB="libmpi_profiler.a"
+fi
+
 echo "Compiling with mpic++..."
-mpic++ -I./include src/main.cpp src/algorithms/*.cpp src/utils/*.cpp -o parallel_computation.o
\ No newline at end of file
+mpic++ -I./include src/main.cpp src/algorithms/*.cpp src/utils/*.cpp $PROFILER_LIB -o parallel_computation.o
@@ -3,14 +3,14 @@
 
 #include <vector>
 #include <mpi.h>
+#include "../utils/sort_types.h"
 
 using namespace std;
 
-bool isPowerOfTwo(int n);
-void compareExchange(vector<int>& arr, int i, int j, bool ascending);
-void bitonicMergeLocal(vector<int>& arr, int start, int len, bool ascending);
-void bitonicSortLocalRecursive(vector<int>& arr, int start, int len, bool ascending);
-vector<int> parallelBitonicSort(vector<int> local_data, int global_data_size,
-                              int rank, int world_size, MPI_Comm comm);
+template<typename T, typename Compare = KeyLess<T>>
+vector<T> parallelBitonicSort(vector<T> local_data, long long global_data_size,
+                              int rank, int world_size, MPI_Comm comm, bool gather_result = true);
+
+#include "bitonic_sort.tpp"
 
 #endif
\ No newline at end of file
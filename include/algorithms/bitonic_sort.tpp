@@ -0,0 +1,316 @@
+// Template definitions of bitonic_sort.h, included at the end of that header.
+
+#include <algorithm>
+#include <vector>
+#include <mpi.h>
+#include <iostream>
+#include <map>
+#include "../utils/data_utils.h"
+#include "../utils/bitonic_kernels.h"
+#include "../utils/local_sort.h"
+#include "../utils/phase_profile.h"
+
+using namespace std;
+
+// Elements per message of the merge-split exchange: merging one chunk overlaps with receiving the next.
+const int BITONIC_CHUNK = 1 << 15;
+const int BOUNDS_TAG = 1;
+const int CHUNK_TAG = 2;
+
+// Element count and first and last element of a block, swapped before each merge-split.
+template<typename T>
+struct BlockBounds {
+    long long count;
+    T first;
+    T last;
+};
+
+// Buffers and persistent requests of the merge-split exchange, shared by all log^2 P steps of a sort.
+// The persistent receives are bound to `received`, which is sized once and never reallocated.
+template<typename T>
+struct MergeSplitExchange {
+    long long block_size;
+    vector<T> output;
+    vector<T> received;
+    BlockBounds<T> bounds_out;
+    BlockBounds<T> bounds_in;
+    map<int, vector<MPI_Request>> bounds_requests;
+    map<int, vector<MPI_Request>> chunk_requests;
+    vector<MPI_Request> send_requests;
+};
+
+template<typename T>
+void initMergeSplitExchange(MergeSplitExchange<T>& ex, long long block_size) {
+    ex.block_size = block_size;
+    ex.output.reserve(block_size);
+    ex.received.resize(((size_t)block_size / BITONIC_CHUNK + 1) * BITONIC_CHUNK);
+}
+
+template<typename T>
+void freeMergeSplitExchange(MergeSplitExchange<T>& ex) {
+    for (auto& entry : ex.bounds_requests)
+        for (MPI_Request& request : entry.second)
+            MPI_Request_free(&request);
+    for (auto& entry : ex.chunk_requests)
+        for (MPI_Request& request : entry.second)
+            if (request != MPI_REQUEST_NULL)
+                MPI_Request_free(&request);
+}
+
+template<typename T>
+MPI_Request* boundsRequests(MergeSplitExchange<T>& ex, int partner, MPI_Comm comm) {
+    vector<MPI_Request>& requests = ex.bounds_requests[partner];
+    if (requests.empty()) {
+        requests.resize(2);
+        MPI_Send_init(&ex.bounds_out, sizeof(BlockBounds<T>), MPI_BYTE, partner, BOUNDS_TAG, comm, &requests[0]);
+        MPI_Recv_init(&ex.bounds_in, sizeof(BlockBounds<T>), MPI_BYTE, partner, BOUNDS_TAG, comm, &requests[1]);
+    }
+    return requests.data();
+}
+
+// Chunk c from `partner` always lands at offset c * BITONIC_CHUNK of the receive buffer.
+template<typename T>
+void startChunkReceive(MergeSplitExchange<T>& ex, int partner, int chunk, MPI_Comm comm) {
+    vector<MPI_Request>& requests = ex.chunk_requests[partner];
+    if (requests.empty())
+        requests.assign(ex.received.size() / BITONIC_CHUNK, MPI_REQUEST_NULL);
+    if (requests[chunk] == MPI_REQUEST_NULL)
+        MPI_Recv_init(ex.received.data() + (size_t)chunk * BITONIC_CHUNK, BITONIC_CHUNK, MpiType<T>::get(),
+                      partner, CHUNK_TAG, comm, &requests[chunk]);
+    MPI_Start(&requests[chunk]);
+}
+
+template<typename T>
+int waitChunkReceive(MergeSplitExchange<T>& ex, int partner, int chunk) {
+    MPI_Status status;
+    MPI_Wait(&ex.chunk_requests[partner][chunk], &status);
+    int count = 0;
+    MPI_Get_count(&status, MpiType<T>::get(), &count);
+    return count;
+}
+
+// Local kernels of a block: the SIMD bitonic networks for ints in ascending order, the standard library for other
+// element types and comparators.
+inline void sortBlock(vector<int>& data, vector<int>& scratch, KeyLess<int>) {
+    bitonicSortKernel(data, scratch);
+}
+
+template<typename T, typename Compare>
+void sortBlock(vector<T>& data, vector<T>&, Compare comp) {
+    localSort(data, comp);
+}
+
+inline void mergeBlocks(const int* a, size_t a_size, const int* b, size_t b_size, int* out, KeyLess<int>) {
+    bitonicMergeKernel(a, a_size, b, b_size, out);
+}
+
+template<typename T, typename Compare>
+void mergeBlocks(const T* a, size_t a_size, const T* b, size_t b_size, T* out, Compare comp) {
+    merge(a, a + a_size, b, b + b_size, out, comp);
+}
+
+inline const char* blockKernelName(const vector<int>&, KeyLess<int>) {
+    return bitonicKernelName();
+}
+
+template<typename T, typename Compare>
+const char* blockKernelName(const vector<T>&, Compare) {
+    return "generic (std::sort, std::merge)";
+}
+
+// Returns i such that the k smallest elements of the merge of x and y are x[0, i) and y[0, k - i), where
+// elements of x come first among equal ones, as in std::merge(x, y).
+template<typename T, typename Compare>
+size_t mergeSplitPoint(const T* x, size_t nx, const T* y, size_t ny, size_t k, Compare comp) {
+    size_t lo = (k > ny) ? k - ny : 0;
+    size_t hi = min(k, nx);
+    while (lo < hi) {
+        size_t i = lo + (hi - lo) / 2;
+        if (!comp(y[k - i - 1], x[i]))
+            lo = i + 1;
+        else
+            hi = i;
+    }
+    return lo;
+}
+
+// Merge-split of two sorted blocks. Both blocks are treated as block_size slots whose unused tail is +infinity,
+// so the lower rank keeps the block_size smallest elements of the pair and the upper rank the rest.
+//
+// Among equal elements those of the lower block come first, on both ranks: every merge and split point takes the
+// lower block's elements as its first range, so the two ranks split a run of equal keys at the same place.
+//
+// The ranks first swap (count, first, last). An element of the lower block that is <= the upper block's first
+// stays where it is, and so does one of the upper block that is >= the lower block's last (beyond the elements
+// the lower rank needs to fill its slots), so only the overlapping part is sent: the lower rank its largest
+// elements first, the upper rank its smallest first, in chunks ending with a short (possibly empty) one.
+// Blocks that do not overlap exchange nothing but that empty chunk. Each chunk is merged as soon as it arrives,
+// as far as its values allow, and only the elements the rank keeps are produced, into the reused output buffer.
+template<typename T, typename Compare>
+void mergeSplitExchange(vector<T>& local_data, MergeSplitExchange<T>& ex, int partner,
+                        bool is_lower_rank, MPI_Comm comm, Compare comp) {
+    ScopedPhase phase("bitonic: merge-split");
+    const T* own = local_data.data();
+    size_t own_count = local_data.size();
+    ex.bounds_out.count = own_count;
+    if (own_count > 0) {
+        ex.bounds_out.first = own[0];
+        ex.bounds_out.last = own[own_count - 1];
+    }
+    MPI_Request* bounds = boundsRequests(ex, partner, comm);
+    MPI_Startall(2, bounds);
+    startChunkReceive(ex, partner, 0, comm);
+    MPI_Waitall(2, bounds, MPI_STATUSES_IGNORE);
+
+    size_t partner_count = ex.bounds_in.count;
+    size_t lower_keep = min((size_t)ex.block_size, own_count + partner_count);
+    size_t keep = is_lower_rank ? lower_keep : own_count + partner_count - lower_keep;
+
+    size_t send_begin = 0, send_end = own_count;
+    if (is_lower_rank) {
+        if (partner_count > 0)
+            send_begin = upper_bound(own, own + own_count, ex.bounds_in.first, comp) - own;
+        else
+            send_begin = own_count;
+    } else {
+        size_t needed = lower_keep - partner_count;
+        if (partner_count > 0)
+            needed = max(needed, (size_t)(lower_bound(own, own + own_count, ex.bounds_in.last, comp) - own));
+        send_end = min(own_count, needed);
+    }
+    size_t send_count = send_end - send_begin;
+    size_t send_chunks = send_count / BITONIC_CHUNK + 1;
+    ex.send_requests.resize(send_chunks);
+    for (size_t c = 0; c < send_chunks; ++c) {
+        size_t n = min((size_t)BITONIC_CHUNK, send_count - c * BITONIC_CHUNK);
+        size_t offset = is_lower_rank ? send_end - c * BITONIC_CHUNK - n : send_begin + c * BITONIC_CHUNK;
+        MPI_Isend(own + offset, n, MpiType<T>::get(), partner, CHUNK_TAG, comm, &ex.send_requests[c]);
+    }
+
+    ex.output.resize(keep);
+    T* out = ex.output.data();
+    size_t received_count = 0;
+    bool unchanged = false;
+    if (is_lower_rank) {
+        // Chunks hold the partner's smallest elements in order; everything up to the last one received is final.
+        const T* in = ex.received.data();
+        size_t i = 0, j = 0, produced = 0;
+        for (int c = 0;; ++c) {
+            int n = waitChunkReceive(ex, partner, c);
+            bool last = n < BITONIC_CHUNK;
+            if (!last)
+                startChunkReceive(ex, partner, c + 1, comm);
+            received_count += n;
+            if (last && received_count == 0 && keep == own_count) {
+                unchanged = true;
+            } else if (produced < keep) {
+                size_t i_end = last ? own_count : upper_bound(own + i, own + own_count, in[received_count - 1], comp) - own;
+                size_t k = min(keep - produced, (i_end - i) + (received_count - j));
+                size_t di = mergeSplitPoint(own + i, i_end - i, in + j, received_count - j, k, comp);
+                mergeBlocks(own + i, di, in + j, k - di, out + produced, comp);
+                produced += k;
+                i += di;
+                j += k - di;
+            }
+            if (last)
+                break;
+        }
+    } else {
+        // Chunks hold the partner's largest elements, largest chunk first; the output is filled from the back.
+        size_t own_end = own_count, pos = keep;
+        for (int c = 0;; ++c) {
+            int n = waitChunkReceive(ex, partner, c);
+            bool last = n < BITONIC_CHUNK;
+            if (!last)
+                startChunkReceive(ex, partner, c + 1, comm);
+            received_count += n;
+            const T* in = ex.received.data() + (size_t)c * BITONIC_CHUNK;
+            if (last && received_count == 0 && keep == own_count) {
+                unchanged = true;
+            } else if (pos > 0) {
+                size_t own_begin = last ? 0 : lower_bound(own, own + own_end, in[0], comp) - own;
+                size_t own_n = own_end - own_begin;
+                size_t skip = n + own_n - min(pos, n + own_n);
+                size_t di = mergeSplitPoint(in, n, own + own_begin, own_n, skip, comp);
+                size_t dj = skip - di;
+                mergeBlocks(in + di, n - di, own + own_begin + dj, own_n - dj, out + pos - (n + own_n - skip), comp);
+                pos -= n + own_n - skip;
+                own_end = own_begin + dj;
+            }
+            if (last)
+                break;
+        }
+    }
+    MPI_Waitall(send_chunks, ex.send_requests.data(), MPI_STATUSES_IGNORE);
+    countPhaseElements(keep);
+    countPhaseBytes(send_count * sizeof(T), received_count * sizeof(T));
+
+    if (!unchanged)
+        local_data.swap(ex.output);
+}
+
+// Blocks are padded (by count) with +infinity up to the largest block, and the process count is padded up to
+// a power of two with virtual ranks that hold only padding. Every comparator sorts ascending: the first step
+// of stage k pairs each rank with its mirror in the group of k ranks, the later steps with rank ^ j. A real rank
+// paired with a virtual one is always the lower rank and keeps its own data, so virtual ranks never communicate.
+template<typename T, typename Compare>
+vector<T> parallelBitonicSort(vector<T> local_data, long long global_data_size_orig,
+                              int rank, int world_size, MPI_Comm comm, bool gather_result) {
+
+    if (global_data_size_orig == 0) {
+        if (rank == 0) {
+            cout << "Warning: Empty data received for sorting" << endl;
+        }
+        return vector<T>();
+    }
+
+    long long local_size = local_data.size();
+    long long block_size = 0;
+    MPI_Allreduce(&local_size, &block_size, 1, MPI_LONG_LONG, MPI_MAX, comm);
+
+    int virtual_size = 1;
+    while (virtual_size < world_size) {
+        virtual_size *= 2;
+    }
+    
+    Compare comp;
+    if (rank == 0) {
+        cout << "Local bitonic kernels: " << blockKernelName(local_data, comp) << endl;
+    }
+    vector<T> scratch;
+    {
+        ScopedPhase phase("bitonic: local sort");
+        countPhaseElements(local_data.size());
+        sortBlock(local_data, scratch, comp);
+    }
+
+    MergeSplitExchange<T> exchange;
+    initMergeSplitExchange(exchange, block_size);
+    for (int k = 2; k <= virtual_size; k *= 2) {
+        for (int j = k / 2; j > 0; j /= 2) {
+            int partner_rank = (j == k / 2) ? (rank ^ (k - 1)) : (rank ^ j);
+            if (partner_rank >= world_size) {
+                continue;
+            }
+            mergeSplitExchange(local_data, exchange, partner_rank, rank < partner_rank, comm, comp);
+        }
+    }
+    freeMergeSplitExchange(exchange);
+
+    if (!gather_result) {
+        return local_data;
+    }
+
+    if (rank == 0) {
+        cout << "Local sort complete, gathering results" << endl;
+    }
+
+    ScopedPhase phase("bitonic: gather");
+    vector<T> result = gatherDataGatherv(local_data, 0, rank, world_size, comm);
+    
+    if (rank == 0 && !result.empty()) {
+        cout << "Successfully gathered sorted data (" << result.size() << " elements)" << endl;
+    }
+    
+    return result;
+}
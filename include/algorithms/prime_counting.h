@@ -0,0 +1,12 @@
+#ifndef PRIME_COUNTING_H
+#define PRIME_COUNTING_H
+
+#include <mpi.h>
+
+using namespace std;
+
+long long parallelPrimePi(long long x, int rank, int world_size, MPI_Comm comm);
+long long parallelPrimeCount(long long lower_bound, long long upper_bound,
+                             int rank, int world_size, MPI_Comm comm);
+
+#endif
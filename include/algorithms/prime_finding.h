@@ -2,11 +2,47 @@
 #define PRIME_FINDING_H
 
 #include <vector>
+#include <string>
 #include <mpi.h>
 
 using namespace std;
+
+enum PrimeEngine {
+    PRIME_ENGINE_AUTO,
+    PRIME_ENGINE_SIEVE,
+    PRIME_ENGINE_TRIAL_DIVISION,
+    PRIME_ENGINE_MILLER_RABIN
+};
+
+enum PrimeSchedule {
+    PRIME_SCHEDULE_STATIC,
+    PRIME_SCHEDULE_DYNAMIC
+};
+
+struct PrimeFindingOptions {
+    PrimeEngine engine = PRIME_ENGINE_AUTO;
+    PrimeSchedule schedule = PRIME_SCHEDULE_STATIC;
+    long long chunk_size = 0;
+    bool report_busy_time = false;
+};
+
+enum PrimeResultMode {
+    PRIME_RESULT_COUNT,
+    PRIME_RESULT_BITSET,
+    PRIME_RESULT_DELTA
+};
+
 bool isPrime(long long n);
+bool millerRabinIsPrime(unsigned long long n);
+vector<unsigned int> computeBasePrimes(unsigned long long limit);
+long long segmentedSieveRange(long long start, long long end,
+                              const vector<unsigned int>& base_primes, vector<long long>* out_primes);
 vector<long long> parallelPrimeFinding(long long lower_bound, long long upper_bound,
-                                      int rank, int world_size, MPI_Comm comm);
+                                      int rank, int world_size, MPI_Comm comm,
+                                      const PrimeFindingOptions& options = PrimeFindingOptions());
+long long parallelPrimeFindingCompact(long long lower_bound, long long upper_bound,
+                                      int rank, int world_size, MPI_Comm comm,
+                                      PrimeResultMode mode, const string& output_filename,
+                                      const PrimeFindingOptions& options = PrimeFindingOptions());
 
-#endif
\ No newline at end of file
+#endif
@@ -7,7 +7,20 @@
 
 using namespace std;
 
-pair<bool, int> parallelQuickSearch(const vector<int>& local_data, int target_value,
-                                   int global_data_size, int rank, int world_size, MPI_Comm comm);
+// Per-rank lookup table for batched queries: the distinct local values in ascending order, each with the
+// global index of its first occurrence on this rank.
+struct SearchIndex {
+    vector<int> values;
+    vector<long long> first_index;
+};
 
-#endif
\ No newline at end of file
+pair<bool, long long> parallelQuickSearch(const vector<int>& local_data, int target_value,
+                                         long long global_data_size, int rank, int world_size, MPI_Comm comm,
+                                         long long* elements_scanned = nullptr);
+long long parallelFindAll(const vector<int>& local_data, int target_value, int root_rank, int rank, int world_size,
+                          MPI_Comm comm, vector<long long>* occurrences);
+SearchIndex buildSearchIndex(const vector<int>& local_data, int rank, MPI_Comm comm);
+vector<long long> parallelBatchSearch(const SearchIndex& index, const vector<int>& targets,
+                                      int root_rank, int rank, MPI_Comm comm);
+
+#endif
@@ -3,11 +3,17 @@
 
 #include <vector>
 #include <mpi.h>
+#include "../utils/sort_types.h"
 
 using namespace std;
 
-void localCountingSortForRadix(vector<int>& arr, int exp);
-vector<int> parallelRadixSort(vector<int> local_data, int global_data_size,
-                             int rank, int world_size, MPI_Comm comm);
+// Stable and ascending by key; a record's payload moves with its key.
+template<typename T>
+void localRadixSort(vector<T>& data);
+template<typename T>
+vector<T> parallelRadixSort(vector<T> local_data, long long global_data_size,
+                            int rank, int world_size, MPI_Comm comm, bool gather_result = true);
+
+#include "radix_sort.tpp"
 
 #endif
\ No newline at end of file
@@ -0,0 +1,225 @@
+// Template definitions of radix_sort.h, included at the end of that header.
+
+#include <algorithm>
+#include <vector>
+#include <cstring>
+#include <utility>
+#include <mpi.h>
+#include "../utils/data_utils.h"
+#include "../utils/mpi_large_count.h"
+#include "../utils/phase_profile.h"
+
+using namespace std;
+
+const int RADIX_BITS = 8;
+const int RADIX_BUCKETS = 1 << RADIX_BITS;
+// Elements staged per bucket before being copied to the output: one 64-byte cache line (at least one element).
+const int RADIX_STAGE_BYTES = 64;
+
+// Keys are mapped to unsigned integers with the same order. Flipping the sign bit maps signed order onto unsigned
+// order; a negative double has all bits flipped, because its magnitude grows with the remaining bits.
+// The keys are computed on the fly, so the elements (and any payload) are moved as they are.
+inline unsigned int radixKey(int value) {
+    return (unsigned int)value ^ 0x80000000u;
+}
+
+inline unsigned long long radixKey(long long value) {
+    return (unsigned long long)value ^ (1ULL << 63);
+}
+
+inline unsigned long long radixKey(unsigned long long value) {
+    return value;
+}
+
+inline unsigned long long radixKey(double value) {
+    unsigned long long bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return (bits >> 63) ? ~bits : bits | (1ULL << 63);
+}
+
+template<typename K, typename P>
+inline auto radixKey(const SortRecord<K, P>& record) -> decltype(radixKey(record.key)) {
+    return radixKey(record.key);
+}
+
+template<typename T>
+struct RadixTraits {
+    typedef decltype(radixKey(declval<T>())) Key;
+    static const int passes = sizeof(Key) * 8 / RADIX_BITS;
+    static const int stage = (sizeof(T) < RADIX_STAGE_BYTES) ? RADIX_STAGE_BYTES / sizeof(T) : 1;
+};
+
+// Histograms of every digit from `first_pass` on, built in a single sweep over the elements.
+template<typename T>
+void computeDigitHistograms(const T* data, size_t n, int first_pass, vector<long long>& hist) {
+    const int passes = RadixTraits<T>::passes;
+    hist.assign(passes * RADIX_BUCKETS, 0);
+    for (size_t i = 0; i < n; i++) {
+        typename RadixTraits<T>::Key key = radixKey(data[i]);
+        for (int pass = first_pass; pass < passes; ++pass)
+            hist[pass * RADIX_BUCKETS + ((key >> (pass * RADIX_BITS)) & (RADIX_BUCKETS - 1))]++;
+    }
+}
+
+// Stable scatter of `in` into `out` by one digit. Elements are staged in a small cache-line sized buffer per bucket
+// and copied out a full line at a time, so the 256 output streams do not thrash the cache and TLB.
+template<typename T>
+void scatterByDigit(const T* in, size_t n, T* out, int shift, const long long* digit_hist) {
+    const int stage = RadixTraits<T>::stage;
+    static thread_local T staging[RADIX_BUCKETS][stage] __attribute__((aligned(64)));
+    size_t offsets[RADIX_BUCKETS];
+    int staged[RADIX_BUCKETS] = {0};
+    size_t running = 0;
+    for (int b = 0; b < RADIX_BUCKETS; b++) {
+        offsets[b] = running;
+        running += digit_hist[b];
+    }
+
+    for (size_t i = 0; i < n; i++) {
+        int b = (radixKey(in[i]) >> shift) & (RADIX_BUCKETS - 1);
+        staging[b][staged[b]++] = in[i];
+        if (staged[b] == stage) {
+            memcpy(out + offsets[b], staging[b], sizeof(staging[b]));
+            offsets[b] += stage;
+            staged[b] = 0;
+        }
+    }
+    for (int b = 0; b < RADIX_BUCKETS; b++) {
+        memcpy(out + offsets[b], staging[b], staged[b] * sizeof(T));
+    }
+}
+
+inline bool isTrivialDigit(const long long* digit_hist, long long n) {
+    return *max_element(digit_hist, digit_hist + RADIX_BUCKETS) == n;
+}
+
+template<typename T>
+void localRadixSort(vector<T>& data) {
+    size_t n = data.size();
+    if (n < 2)
+        return;
+
+    vector<T> scratch(n);
+    vector<long long> hist;
+    computeDigitHistograms(data.data(), n, 0, hist);
+    for (int pass = 0; pass < RadixTraits<T>::passes; ++pass) {
+        const long long* digit_hist = &hist[pass * RADIX_BUCKETS];
+        if (isTrivialDigit(digit_hist, n))
+            continue;
+        scatterByDigit(data.data(), n, scratch.data(), pass * RADIX_BITS, digit_hist);
+        data.swap(scratch);
+    }
+}
+
+// One LSD pass. After the local stable sort by digit, every key's global position is
+//   (keys with a smaller digit anywhere) + (keys with this digit on lower ranks) + (its index within the local bucket),
+// which increases along the local array, so the buffer can be sent as is to the ranks owning those positions.
+// Receivers get the pieces in source-rank order, and a stable sort by the same digit restores the global order.
+// On return `local_hist` holds the histograms of the received keys for this and all later digits.
+template<typename T>
+void distributedRadixPass(vector<T>& keys, vector<T>& scratch, int pass,
+                          vector<long long>& local_hist, const vector<long long>& global_hist,
+                          const vector<long long>& block_counts, const vector<long long>& block_displs,
+                          int rank, int world_size, MPI_Comm comm) {
+    int shift = pass * RADIX_BITS;
+    const long long* digit_hist = &local_hist[pass * RADIX_BUCKETS];
+    const long long* global_digit_hist = &global_hist[pass * RADIX_BUCKETS];
+    vector<long long> lower_rank_hist(RADIX_BUCKETS, 0);
+    MPI_Exscan(digit_hist, lower_rank_hist.data(), RADIX_BUCKETS, MPI_LONG_LONG, MPI_SUM, comm);
+    if (rank == 0)
+        fill(lower_rank_hist.begin(), lower_rank_hist.end(), 0);
+
+    {
+        ScopedPhase phase("radix: digit scatter");
+        countPhaseElements(keys.size());
+        scratch.resize(keys.size());
+        scatterByDigit(keys.data(), keys.size(), scratch.data(), shift, digit_hist);
+        keys.swap(scratch);
+    }
+
+    ScopedPhase exchange_phase("radix: exchange");
+    vector<long long> sendcounts(world_size, 0);
+    long long digit_start = 0;
+    int dest = 0;
+    for (int b = 0; b < RADIX_BUCKETS; b++) {
+        long long position = digit_start + lower_rank_hist[b];
+        long long remaining = digit_hist[b];
+        digit_start += global_digit_hist[b];
+        while (remaining > 0) {
+            while (position >= block_displs[dest] + block_counts[dest])
+                dest++;
+            long long take = min(remaining, block_displs[dest] + block_counts[dest] - position);
+            sendcounts[dest] += take;
+            position += take;
+            remaining -= take;
+        }
+    }
+
+    vector<long long> recvcounts(world_size);
+    MPI_Alltoall(sendcounts.data(), 1, MPI_LONG_LONG, recvcounts.data(), 1, MPI_LONG_LONG, comm);
+
+    vector<long long> sdispls(world_size, 0), rdispls(world_size, 0);
+    for (int i = 1; i < world_size; ++i) {
+        sdispls[i] = sdispls[i - 1] + sendcounts[i - 1];
+        rdispls[i] = rdispls[i - 1] + recvcounts[i - 1];
+    }
+
+    scratch.resize(block_counts[rank]);
+    largeAlltoallv(keys.data(), sendcounts, sdispls, scratch.data(), recvcounts, rdispls, MpiType<T>::get(), comm);
+    keys.swap(scratch);
+    countPhaseElements(keys.size());
+    exchange_phase.close();
+
+    ScopedPhase phase("radix: digit scatter");
+    countPhaseElements(keys.size());
+    computeDigitHistograms(keys.data(), keys.size(), pass, local_hist);
+    scratch.resize(keys.size());
+    scatterByDigit(keys.data(), keys.size(), scratch.data(), shift, &local_hist[pass * RADIX_BUCKETS]);
+    keys.swap(scratch);
+}
+
+template<typename T>
+vector<T> parallelRadixSort(vector<T> local_data, long long global_data_size,
+                            int rank, int world_size, MPI_Comm comm, bool gather_result) {
+    if (global_data_size == 0)
+        return gather_result ? gatherDataGatherv(local_data, 0, rank, world_size, comm) : local_data;
+
+    if (world_size == 1) {
+        ScopedPhase phase("radix: local sort");
+        countPhaseElements(local_data.size());
+        localRadixSort(local_data);
+        return local_data;
+    }
+
+    vector<T> scratch;
+
+    // The result is balanced like the input: rank i ends up with the i-th block of the sorted order.
+    vector<long long> block_counts, block_displs;
+    computeBlockPartition(global_data_size, world_size, block_counts, block_displs);
+
+    // Redistribution does not change the global digit counts, so every pass is planned from one reduction.
+    const int passes = RadixTraits<T>::passes;
+    vector<long long> local_hist;
+    vector<long long> global_hist(passes * RADIX_BUCKETS, 0);
+    {
+        ScopedPhase phase("radix: histograms");
+        countPhaseElements(local_data.size());
+        computeDigitHistograms(local_data.data(), local_data.size(), 0, local_hist);
+        MPI_Allreduce(local_hist.data(), global_hist.data(), passes * RADIX_BUCKETS, MPI_LONG_LONG, MPI_SUM, comm);
+    }
+
+    for (int pass = 0; pass < passes; ++pass) {
+        // A digit shared by every key leaves the order unchanged, so the pass can be skipped.
+        if (isTrivialDigit(&global_hist[pass * RADIX_BUCKETS], global_data_size))
+            continue;
+
+        distributedRadixPass(local_data, scratch, pass, local_hist, global_hist,
+                             block_counts, block_displs, rank, world_size, comm);
+    }
+
+    if (!gather_result) {
+        return local_data;
+    }
+    ScopedPhase phase("radix: gather");
+    return gatherDataGatherv(local_data, 0, rank, world_size, comm);
+}
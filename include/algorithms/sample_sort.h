@@ -3,13 +3,16 @@
 
 #include <vector>
 #include <mpi.h>
+#include "../utils/sort_types.h"
 
 using namespace std;
 
-void merge(vector<int>& arr, int left, int mid, int right);
-void mergeSort(vector<int>& arr, int left, int right);
 void sortVector(vector<int>& arr);
-vector<int> parallelSampleSort(vector<int> local_data, int global_data_size,
-                             int rank, int world_size, MPI_Comm comm);
+template<typename T, typename Compare = KeyLess<T>>
+vector<T> parallelSampleSort(vector<T> local_data, long long global_data_size,
+                             int rank, int world_size, MPI_Comm comm, bool gather_result = true,
+                             int oversampling = 0);
+
+#include "sample_sort.tpp"
 
 #endif
\ No newline at end of file
@@ -0,0 +1,241 @@
+// Template definitions of sample_sort.h, included at the end of that header.
+
+#include <algorithm>
+#include <vector>
+#include <iostream>
+#include <iomanip>
+#include <cstddef>
+#include <mpi.h>
+#include "../utils/data_utils.h"
+#include "../utils/local_sort.h"
+#include "../utils/kway_merge.h"
+#include "../utils/mpi_large_count.h"
+#include "../utils/phase_profile.h"
+
+using namespace std;
+
+// Samples each rank takes per splitter from the part of its data the splitter may still fall in.
+const int DEFAULT_OVERSAMPLING = 16;
+// A splitter is accepted once its global rank is within this fraction of a block from its target.
+const double SPLITTER_TOLERANCE = 0.01;
+const int MAX_SPLITTER_ROUNDS = 16;
+
+// Keys are ordered by (value, owner rank, index), which makes every key distinct: a run of equal values spanning
+// several ranks can be cut anywhere, so heavy duplicates are spread over the buckets like any other keys.
+template<typename T>
+struct SampleKey {
+    T value;
+    int owner;
+    long long index;
+};
+
+template<typename T>
+MPI_Datatype createSampleKeyType() {
+    int lengths[3] = {1, 1, 1};
+    MPI_Aint offsets[3] = {offsetof(SampleKey<T>, value), offsetof(SampleKey<T>, owner), offsetof(SampleKey<T>, index)};
+    MPI_Datatype types[3] = {MpiType<T>::get(), MPI_INT, MPI_LONG_LONG};
+    MPI_Datatype struct_type, key_type;
+    MPI_Type_create_struct(3, lengths, offsets, types, &struct_type);
+    MPI_Type_create_resized(struct_type, 0, sizeof(SampleKey<T>), &key_type);
+    MPI_Type_commit(&key_type);
+    MPI_Type_free(&struct_type);
+    return key_type;
+}
+
+template<typename T, typename Compare>
+bool sampleKeyLess(const SampleKey<T>& a, const SampleKey<T>& b, Compare comp) {
+    if (comp(a.value, b.value)) return true;
+    if (comp(b.value, a.value)) return false;
+    if (a.owner != b.owner) return a.owner < b.owner;
+    return a.index < b.index;
+}
+
+// First position at or after `from` whose value is not below `value`. The search gallops forward from `from`
+// before bisecting, so a sorted batch of queries walks the data once instead of bisecting all of it each time.
+template<typename T, typename Compare>
+size_t gallopLowerBound(const vector<T>& data, size_t from, const T& value, Compare comp) {
+    size_t step = 1, hi = from;
+    while (hi < data.size() && comp(data[hi], value)) {
+        from = hi + 1;
+        hi += step;
+        step *= 2;
+    }
+    return lower_bound(data.begin() + from, data.begin() + min(hi, data.size()), value, comp) - data.begin();
+}
+
+// Number of keys of this rank's sorted data that are smaller than `key`. Keys given in increasing order
+// have non-decreasing local ranks, so the previous result can be passed as `from`.
+template<typename T, typename Compare>
+long long localKeyRank(const vector<T>& data, int rank, const SampleKey<T>& key, size_t from, Compare comp) {
+    size_t first = gallopLowerBound(data, from, key.value, comp);
+    if (rank > key.owner) return first;
+    if (rank < key.owner) return upper_bound(data.begin() + first, data.end(), key.value, comp) - data.begin();
+    return key.index;
+}
+
+// Histogram-based splitter selection (HSS). Splitter i should have global rank target_i, the first index of
+// block i + 1 in the block partition. Every splitter keeps a bracket: the known keys with the closest global
+// ranks below and above its target, stored as positions in each rank's local data. Each round, every rank
+// samples its keys inside the open brackets, the samples are exchanged, and one Allreduce of their local ranks
+// gives all of their global ranks, which narrows the brackets. Returns the local cut of every splitter.
+template<typename T, typename Compare>
+vector<long long> selectSplitterCuts(const vector<T>& local_data, long long global_data_size, int oversampling,
+                                     int rank, int world_size, MPI_Comm comm, int& rounds, Compare comp) {
+    int splitters = world_size - 1;
+    vector<long long> block_counts, block_displs;
+    computeBlockPartition(global_data_size, world_size, block_counts, block_displs);
+    long long tolerance = (long long)(SPLITTER_TOLERANCE * global_data_size / world_size);
+
+    vector<long long> target(splitters), lo_rank(splitters, 0), hi_rank(splitters, global_data_size);
+    vector<long long> lo_cut(splitters, 0), hi_cut(splitters, local_data.size());
+    for (int i = 0; i < splitters; ++i)
+        target[i] = block_displs[i + 1];
+
+    MPI_Datatype key_type = createSampleKeyType<T>();
+    vector<SampleKey<T>> samples, all_samples;
+    vector<int> sample_counts(world_size), sample_displs(world_size);
+    vector<long long> local_ranks, global_ranks;
+    for (rounds = 0; rounds < MAX_SPLITTER_ROUNDS; ++rounds) {
+        // Splitters sharing a bracket (all of them in the first round) sample it together.
+        samples.clear();
+        int open = 0;
+        for (int i = 0; i < splitters; ++i) {
+            if (min(target[i] - lo_rank[i], hi_rank[i] - target[i]) <= tolerance)
+                continue;
+            open++;
+            int sharing = 1;
+            while (i + 1 < splitters && lo_cut[i + 1] == lo_cut[i] && hi_cut[i + 1] == hi_cut[i]
+                   && lo_rank[i + 1] == lo_rank[i]) {
+                sharing++;
+                i++;
+            }
+            long long len = hi_cut[i] - lo_cut[i];
+            long long count = min(len, (long long)oversampling * sharing);
+            for (long long j = 0; j < count; ++j) {
+                long long index = lo_cut[i] + ((2 * j + 1) * len) / (2 * count);
+                samples.push_back({local_data[index], rank, index});
+            }
+        }
+        if (open == 0)
+            break;
+
+        int sample_count = samples.size();
+        MPI_Allgather(&sample_count, 1, MPI_INT, sample_counts.data(), 1, MPI_INT, comm);
+        int total_samples = 0;
+        for (int r = 0; r < world_size; ++r) {
+            sample_displs[r] = total_samples;
+            total_samples += sample_counts[r];
+        }
+        all_samples.resize(total_samples);
+        countPhaseBytes((long long)sample_count * sizeof(SampleKey<T>) * (world_size - 1),
+                        (long long)(total_samples - sample_count) * sizeof(SampleKey<T>));
+        MPI_Allgatherv(samples.data(), sample_count, key_type, all_samples.data(),
+                       sample_counts.data(), sample_displs.data(), key_type, comm);
+        sort(all_samples.begin(), all_samples.end(),
+             [&](const SampleKey<T>& a, const SampleKey<T>& b) { return sampleKeyLess(a, b, comp); });
+
+        local_ranks.resize(all_samples.size());
+        for (size_t s = 0; s < all_samples.size(); ++s)
+            local_ranks[s] = localKeyRank(local_data, rank, all_samples[s], (s == 0) ? 0 : local_ranks[s - 1], comp);
+        global_ranks.resize(all_samples.size());
+        MPI_Allreduce(local_ranks.data(), global_ranks.data(), all_samples.size(), MPI_LONG_LONG, MPI_SUM, comm);
+
+        // Global ranks grow with the sorted samples, so each bracket is narrowed by a binary search.
+        for (int i = 0; i < splitters; ++i) {
+            size_t above = lower_bound(global_ranks.begin(), global_ranks.end(), target[i]) - global_ranks.begin();
+            if (above < global_ranks.size() && global_ranks[above] < hi_rank[i]) {
+                hi_rank[i] = global_ranks[above];
+                hi_cut[i] = local_ranks[above];
+            }
+            size_t below = upper_bound(global_ranks.begin(), global_ranks.end(), target[i]) - global_ranks.begin();
+            if (below > 0 && global_ranks[below - 1] > lo_rank[i]) {
+                lo_rank[i] = global_ranks[below - 1];
+                lo_cut[i] = local_ranks[below - 1];
+            }
+        }
+    }
+
+    MPI_Type_free(&key_type);
+
+    // Every rank picks the same key for each splitter, so keeping the cuts monotone stays consistent globally.
+    vector<long long> cuts(splitters);
+    for (int i = 0; i < splitters; ++i) {
+        cuts[i] = (target[i] - lo_rank[i] <= hi_rank[i] - target[i]) ? lo_cut[i] : hi_cut[i];
+        if (i > 0)
+            cuts[i] = max(cuts[i], cuts[i - 1]);
+    }
+    return cuts;
+}
+
+template<typename T, typename Compare>
+vector<T> parallelSampleSort(vector<T> local_data, long long global_data_size,
+                             int rank, int world_size, MPI_Comm comm, bool gather_result, int oversampling) {
+    if (global_data_size == 0) return gather_result ? gatherDataGatherv(local_data, 0, rank, world_size, comm) : local_data;
+    Compare comp;
+    {
+        ScopedPhase phase("sample: local sort");
+        countPhaseElements(local_data.size());
+        localSort(local_data, comp);
+    }
+    if (world_size == 1) return local_data;
+    if (oversampling <= 0) oversampling = DEFAULT_OVERSAMPLING;
+
+    int rounds = 0;
+    vector<long long> cuts;
+    {
+        ScopedPhase phase("sample: splitters");
+        cuts = selectSplitterCuts(local_data, global_data_size, oversampling, rank, world_size, comm, rounds, comp);
+    }
+
+    // The local data is sorted, so bucket i is the contiguous range between the cuts of splitters i - 1 and i.
+    vector<long long> send_counts_atoa(world_size);
+    vector<long long> send_displs_atoa(world_size, 0);
+    for (int i = 0; i < world_size; ++i) {
+        send_displs_atoa[i] = (i == 0) ? 0 : cuts[i - 1];
+        long long bucket_end = (i == world_size - 1) ? (long long)local_data.size() : cuts[i];
+        send_counts_atoa[i] = bucket_end - send_displs_atoa[i];
+    }
+
+    vector<long long> recv_counts_atoa(world_size);
+    vector<long long> recv_displs_atoa(world_size, 0);
+    long long total_recv_size_atoa = 0;
+    vector<T> recv_buffer_atoa;
+    {
+        ScopedPhase phase("sample: exchange");
+        MPI_Alltoall(send_counts_atoa.data(), 1, MPI_LONG_LONG, recv_counts_atoa.data(), 1, MPI_LONG_LONG, comm);
+        for (int i = 0; i < world_size; ++i) {
+            recv_displs_atoa[i] = total_recv_size_atoa;
+            total_recv_size_atoa += recv_counts_atoa[i];
+        }
+
+        recv_buffer_atoa.resize(total_recv_size_atoa);
+        countPhaseElements(total_recv_size_atoa);
+        largeAlltoallv(local_data.data(), send_counts_atoa, send_displs_atoa,
+                       recv_buffer_atoa.data(), recv_counts_atoa, recv_displs_atoa, MpiType<T>::get(), comm);
+    }
+
+    long long max_bucket = 0;
+    MPI_Reduce(&total_recv_size_atoa, &max_bucket, 1, MPI_LONG_LONG, MPI_MAX, 0, comm);
+    if (rank == 0) {
+        double average = (double)global_data_size / world_size;
+        cout << "Sample sort splitters: oversampling " << oversampling << ", " << rounds << " refinement round(s)" << endl;
+        cout << "Bucket imbalance: largest " << max_bucket << " elements, average " << fixed << setprecision(1)
+             << average << ", factor " << setprecision(3) << max_bucket / average << endl;
+        cout.unsetf(ios::floatfield);
+        cout << setprecision(6);
+    }
+
+    // Each received piece is already sorted, so a k-way merge straight into local_data is enough.
+    {
+        ScopedPhase phase("sample: merge");
+        countPhaseElements(total_recv_size_atoa);
+        local_data.resize(total_recv_size_atoa);
+        kWayMerge(recv_buffer_atoa.data(), recv_counts_atoa, recv_displs_atoa, local_data.data(), comp);
+    }
+
+    if (!gather_result) {
+        return local_data;
+    }
+    ScopedPhase phase("sample: gather");
+    return gatherDataGatherv(local_data, 0, rank, world_size, comm);
+}
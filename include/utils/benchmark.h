@@ -0,0 +1,15 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <string>
+#include <mpi.h>
+
+using namespace std;
+
+// Runs every job of a job spec in this MPI session and writes the timing statistics as CSV and JSON.
+// Job lines: `algorithm input [repetitions] [warmup] [key=value ...]`, see docs/performance_analysis.md.
+// Returns 0 on success, 1 if the spec could not be read or a job was invalid.
+int runBenchmarks(const string& spec_filename, const string& csv_filename, const string& json_filename,
+                  int root_rank, int rank, int world_size, MPI_Comm comm);
+
+#endif
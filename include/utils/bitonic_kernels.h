@@ -0,0 +1,13 @@
+#ifndef BITONIC_KERNELS_H
+#define BITONIC_KERNELS_H
+
+#include <vector>
+#include <cstddef>
+
+using namespace std;
+
+void bitonicSortKernel(vector<int>& data, vector<int>& scratch);
+void bitonicMergeKernel(const int* a, size_t a_size, const int* b, size_t b_size, int* out);
+const char* bitonicKernelName();
+
+#endif
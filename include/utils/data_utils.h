@@ -4,13 +4,33 @@
 #include <vector>
 #include <string>
 #include <mpi.h>
+#include "sort_types.h"
 
 using namespace std;
 
-vector<int> readFileData(const string& filename, int root_rank, int rank, MPI_Comm comm, int& out_global_size);
-void distributeDataScatterv(const vector<int>& global_data, vector<int>& local_data,
+// Binary input files: 4-byte magic "PCDB", uint32 element width (4 or 8), uint64 element count,
+// then the elements in little-endian order.
+const int BINARY_HEADER_BYTES = 16;
+
+vector<int> readFileData(const string& filename, int root_rank, int rank, MPI_Comm comm, long long& out_global_size);
+template<typename T>
+void distributeDataScatterv(const vector<T>& global_data, vector<T>& local_data,
+                            int root_rank, int rank, int world_size, MPI_Comm comm);
+template<typename T>
+vector<T> gatherDataGatherv(const vector<T>& local_data,
                             int root_rank, int rank, int world_size, MPI_Comm comm);
-vector<int> gatherDataGatherv(const vector<int>& local_data,
-                                  int root_rank, int rank, int world_size, MPI_Comm comm);
+void computeBlockPartition(long long global_size, int world_size, vector<long long>& counts, vector<long long>& displs);
+bool readBinaryFileDistributed(const string& filename, vector<int>& local_data,
+                               int root_rank, int rank, int world_size, MPI_Comm comm, long long& out_global_size);
+bool readTextFileDistributed(const string& filename, vector<int>& local_data,
+                             int root_rank, int rank, int world_size, MPI_Comm comm, long long& out_global_size);
+bool loadDistributedData(const string& filename, vector<int>& local_data,
+                         int root_rank, int rank, int world_size, MPI_Comm comm, long long& out_global_size);
+bool writeDistributedData(const string& filename, const vector<int>& local_data, bool binary,
+                          int root_rank, int rank, MPI_Comm comm);
+unsigned long long distributedChecksum(const vector<int>& local_data, MPI_Comm comm);
+bool isDistributedSorted(const vector<int>& local_data, int rank, int world_size, MPI_Comm comm);
+
+#include "data_utils.tpp"
 
 #endif
\ No newline at end of file
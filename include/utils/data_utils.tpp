@@ -0,0 +1,61 @@
+// Template definitions of data_utils.h, included at the end of that header.
+
+#include <vector>
+#include <mpi.h>
+#include "mpi_large_count.h"
+
+using namespace std;
+
+template<typename T>
+void distributeDataScatterv(const vector<T>& global_data, vector<T>& local_data,
+                            int root_rank, int rank, int world_size, MPI_Comm comm) {
+    long long global_size = 0;
+    if (rank == root_rank) {
+        global_size = global_data.size();
+    }
+    MPI_Bcast(&global_size, 1, MPI_LONG_LONG, root_rank, comm);
+
+    if (global_size == 0) {
+        local_data.clear();
+        return;
+    }
+
+    vector<long long> sendcounts;
+    vector<long long> displs;
+    computeBlockPartition(global_size, world_size, sendcounts, displs);
+
+    local_data.resize(sendcounts[rank]);
+    largeScatterv(global_data.data(), sendcounts, displs,
+                  local_data.data(), sendcounts[rank], MpiType<T>::get(),
+                  root_rank, comm);
+}
+
+template<typename T>
+vector<T> gatherDataGatherv(const vector<T>& local_data,
+                            int root_rank, int rank, int world_size, MPI_Comm comm) {
+    long long local_size = local_data.size();
+    vector<long long> recvcounts;
+    if (rank == root_rank) {
+        recvcounts.resize(world_size);
+    }
+
+    MPI_Gather(&local_size, 1, MPI_LONG_LONG,
+               (rank == root_rank) ? recvcounts.data() : nullptr, 1, MPI_LONG_LONG,
+               root_rank, comm);
+
+    vector<T> global_data;
+    vector<long long> displs;
+    long long total_size = 0;
+    if (rank == root_rank) {
+        displs.resize(world_size);
+        for (int i = 0; i < world_size; ++i) {
+            displs[i] = (i == 0) ? 0 : displs[i - 1] + recvcounts[i - 1];
+            total_size += recvcounts[i];
+        }
+        global_data.resize(total_size);
+    }
+
+    largeGatherv(local_data.data(), local_size, global_data.data(), recvcounts, displs,
+                 MpiType<T>::get(), root_rank, comm);
+    return global_data;
+}
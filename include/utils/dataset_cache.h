@@ -0,0 +1,19 @@
+#ifndef DATASET_CACHE_H
+#define DATASET_CACHE_H
+
+#include <vector>
+#include <string>
+#include <mpi.h>
+
+using namespace std;
+
+// Datasets loaded through the cache stay resident on every rank between menu runs. An entry is keyed by path
+// and reused while the file's size and modification time (as seen by the root) are unchanged.
+// All functions are collective and must be called with the same filename on every rank.
+const vector<int>& acquireDataset(const string& filename, int root_rank, int rank, int world_size, MPI_Comm comm,
+                                  long long& out_global_size, bool& cache_hit);
+bool evictDataset(const string& filename);
+void evictAllDatasets();
+void reportDatasetCache(int root_rank, int rank, int world_size, MPI_Comm comm);
+
+#endif
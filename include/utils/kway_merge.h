@@ -0,0 +1,20 @@
+#ifndef KWAY_MERGE_H
+#define KWAY_MERGE_H
+
+#include <vector>
+#include "sort_types.h"
+
+using namespace std;
+
+void kWayMerge(const int* data, const vector<long long>& run_counts, const vector<long long>& run_displs, int* out);
+inline void kWayMerge(const int* data, const vector<long long>& run_counts, const vector<long long>& run_displs,
+                      int* out, KeyLess<int>) {
+    kWayMerge(data, run_counts, run_displs, out);
+}
+template<typename T, typename Compare = KeyLess<T>>
+void kWayMerge(const T* data, const vector<long long>& run_counts, const vector<long long>& run_displs, T* out,
+               Compare comp = Compare());
+
+#include "kway_merge.tpp"
+
+#endif
@@ -0,0 +1,65 @@
+// Template definitions of kway_merge.h, included at the end of that header.
+
+#include <vector>
+#include <algorithm>
+
+using namespace std;
+
+// Same loser tree as the int merge for the other element types and comparators. The tree holds run indices and
+// compares the runs' heads; an exhausted run (or a padding leaf) loses every match and equal heads leave in run order.
+template<typename T, typename Compare>
+void kWayMerge(const T* data, const vector<long long>& run_counts, const vector<long long>& run_displs, T* out,
+               Compare comp) {
+    vector<const T*> heads, ends;
+    size_t total = 0;
+    for (size_t i = 0; i < run_counts.size(); ++i) {
+        if (run_counts[i] > 0) {
+            heads.push_back(data + run_displs[i]);
+            ends.push_back(data + run_displs[i] + run_counts[i]);
+            total += run_counts[i];
+        }
+    }
+    size_t runs = heads.size();
+    if (runs == 0)
+        return;
+    if (runs == 1) {
+        copy(heads[0], ends[0], out);
+        return;
+    }
+
+    auto comes_first = [&](size_t a, size_t b) {
+        if (b >= runs || heads[b] == ends[b])
+            return true;
+        if (a >= runs || heads[a] == ends[a])
+            return false;
+        if (comp(*heads[a], *heads[b]))
+            return true;
+        if (comp(*heads[b], *heads[a]))
+            return false;
+        return a < b;
+    };
+
+    size_t leaf_count = 1;
+    while (leaf_count < runs)
+        leaf_count *= 2;
+    vector<size_t> tree(leaf_count), winners(2 * leaf_count);
+    for (size_t leaf = 0; leaf < leaf_count; ++leaf)
+        winners[leaf_count + leaf] = leaf;
+    for (size_t node = leaf_count - 1; node > 0; --node) {
+        size_t left = winners[2 * node], right = winners[2 * node + 1];
+        bool left_wins = comes_first(left, right);
+        winners[node] = left_wins ? left : right;
+        tree[node] = left_wins ? right : left;
+    }
+
+    size_t winner = winners[1];
+    for (size_t i = 0; i < total; ++i) {
+        out[i] = *heads[winner]++;
+        size_t entry = winner;
+        for (size_t node = (winner + leaf_count) / 2; node > 0; node /= 2) {
+            if (comes_first(tree[node], entry))
+                swap(tree[node], entry);
+        }
+        winner = entry;
+    }
+}
@@ -0,0 +1,20 @@
+#ifndef LOCAL_SORT_H
+#define LOCAL_SORT_H
+
+#include <vector>
+#include <cstddef>
+#include "sort_types.h"
+
+using namespace std;
+
+void localSort(vector<int>& data);
+void localSort(int* data, size_t n, vector<int>& scratch);
+inline void localSort(vector<int>& data, KeyLess<int>) {
+    localSort(data);
+}
+template<typename T, typename Compare = KeyLess<T>>
+void localSort(vector<T>& data, Compare comp = Compare());
+
+#include "local_sort.tpp"
+
+#endif
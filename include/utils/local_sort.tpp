@@ -0,0 +1,12 @@
+// Template definitions of local_sort.h, included at the end of that header.
+
+#include <vector>
+#include <algorithm>
+
+using namespace std;
+
+// Other element types and comparators sort in place, without a scratch copy of the records.
+template<typename T, typename Compare>
+void localSort(vector<T>& data, Compare comp) {
+    sort(data.begin(), data.end(), comp);
+}
@@ -0,0 +1,21 @@
+#ifndef MPI_LARGE_COUNT_H
+#define MPI_LARGE_COUNT_H
+
+#include <vector>
+#include <mpi.h>
+
+using namespace std;
+
+// Collectives whose counts and displacements (in elements of `type`) may exceed INT_MAX.
+void largeAlltoallv(const void* sendbuf, const vector<long long>& sendcounts, const vector<long long>& sdispls,
+                    void* recvbuf, const vector<long long>& recvcounts, const vector<long long>& rdispls,
+                    MPI_Datatype type, MPI_Comm comm);
+void largeGatherv(const void* sendbuf, long long sendcount, void* recvbuf,
+                  const vector<long long>& recvcounts, const vector<long long>& displs,
+                  MPI_Datatype type, int root, MPI_Comm comm);
+void largeScatterv(const void* sendbuf, const vector<long long>& sendcounts, const vector<long long>& displs,
+                   void* recvbuf, long long recvcount, MPI_Datatype type, int root, MPI_Comm comm);
+void largeFileReadAtAll(MPI_File fh, MPI_Offset offset, void* buf, long long count,
+                        MPI_Datatype type, MPI_Comm comm);
+
+#endif
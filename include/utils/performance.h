@@ -7,7 +7,9 @@
 using namespace std;
 
 
-void analyzeAndPrintPerformance(const string& algo_name, int data_size,
+void analyzeAndPrintPerformance(const string& algo_name, long long data_size,
                                 int num_processes, double time_taken, int rank, MPI_Comm comm);
+void reportPerRankTimes(const string& label, double local_time, long long local_items,
+                        int rank, int world_size, MPI_Comm comm);
 
 #endif
\ No newline at end of file
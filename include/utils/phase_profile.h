@@ -0,0 +1,37 @@
+#ifndef PHASE_PROFILE_H
+#define PHASE_PROFILE_H
+
+#include <string>
+#include <mpi.h>
+
+using namespace std;
+
+// Phases are named regions of an algorithm, marked by a ScopedPhase that closes the phase when it goes out of scope.
+// While profiling is enabled, every rank records the wall time of each phase together with the bytes it sent and
+// received and the elements it processed; counters are charged to the innermost open phase. Phases may nest, and a
+// phase's time includes the phases nested in it. Recording is local to the rank; only the report and the trace
+// are collective. With profiling disabled (the default) a ScopedPhase costs a branch.
+struct ScopedPhase {
+    explicit ScopedPhase(const char* name);
+    ~ScopedPhase();
+    // Ends the phase before the end of the scope.
+    void close();
+    ScopedPhase(const ScopedPhase&) = delete;
+    ScopedPhase& operator=(const ScopedPhase&) = delete;
+
+    bool active;
+};
+
+void enablePhaseProfile(bool enabled);
+bool phaseProfileEnabled();
+// Clears all phases and events; trace timestamps are taken relative to this call.
+void resetPhaseProfile();
+void countPhaseBytes(long long sent, long long received);
+void countPhaseElements(long long elements);
+
+// Prints min / avg / max over the ranks and the imbalance (max / avg) of every phase seen on any rank.
+void reportPhaseProfile(int root_rank, int rank, int world_size, MPI_Comm comm);
+// Writes the phases of every rank as a Chrome trace (chrome://tracing, Perfetto), one thread per rank.
+bool writePhaseTrace(const string& filename, int root_rank, int rank, int world_size, MPI_Comm comm);
+
+#endif
@@ -0,0 +1,12 @@
+#ifndef SCAN_KERNELS_H
+#define SCAN_KERNELS_H
+
+#include <cstddef>
+
+using namespace std;
+
+size_t scanFirstEqual(const int* data, size_t n, int value);
+size_t scanCountEqual(const int* data, size_t n, int value);
+const char* scanKernelName();
+
+#endif
@@ -0,0 +1,60 @@
+#ifndef SORT_TYPES_H
+#define SORT_TYPES_H
+
+#include <mpi.h>
+
+using namespace std;
+
+// A key with a fixed-size payload that moves with it, such as a row index for argsort.
+// The default comparator orders records by key only. Records must be trivially copyable, so they are sent as raw bytes.
+template<typename K, typename P>
+struct SortRecord {
+    K key;
+    P payload;
+};
+
+typedef SortRecord<int, long long> IntIndexRecord;
+typedef SortRecord<long long, long long> Int64IndexRecord;
+typedef SortRecord<unsigned long long, long long> UInt64IndexRecord;
+typedef SortRecord<double, long long> DoubleIndexRecord;
+
+template<typename T> struct MpiType;
+template<> struct MpiType<int> { static MPI_Datatype get() { return MPI_INT; } };
+template<> struct MpiType<unsigned int> { static MPI_Datatype get() { return MPI_UNSIGNED; } };
+template<> struct MpiType<long long> { static MPI_Datatype get() { return MPI_LONG_LONG; } };
+template<> struct MpiType<unsigned long long> { static MPI_Datatype get() { return MPI_UNSIGNED_LONG_LONG; } };
+template<> struct MpiType<float> { static MPI_Datatype get() { return MPI_FLOAT; } };
+template<> struct MpiType<double> { static MPI_Datatype get() { return MPI_DOUBLE; } };
+
+// Created on first use (after MPI_Init) and kept for the rest of the run.
+template<typename K, typename P>
+struct MpiType<SortRecord<K, P>> {
+    static MPI_Datatype get() {
+        static MPI_Datatype record_type = MPI_DATATYPE_NULL;
+        if (record_type == MPI_DATATYPE_NULL) {
+            MPI_Type_contiguous(sizeof(SortRecord<K, P>), MPI_BYTE, &record_type);
+            MPI_Type_commit(&record_type);
+        }
+        return record_type;
+    }
+};
+
+template<typename T>
+inline const T& sortKey(const T& value) {
+    return value;
+}
+
+template<typename K, typename P>
+inline const K& sortKey(const SortRecord<K, P>& record) {
+    return record.key;
+}
+
+// Default comparator of the templated sorts: ascending by key.
+template<typename T>
+struct KeyLess {
+    bool operator()(const T& a, const T& b) const {
+        return sortKey(a) < sortKey(b);
+    }
+};
+
+#endif
@@ -4,7 +4,7 @@ import math
 import tempfile
 import numpy as np
 import matplotlib.pyplot as plt
-import re
+import csv
 
 # --- configuration ---
 MAX_PROCS = 6
@@ -14,19 +14,17 @@ OTHER_PROCS = list(range(1, MAX_PROCS+1))
 SIZES = [1_000, 10_000, 100_000, 1_000_000]
 EXE = "./parallel_computation.o"
 
-# directories for inputs and graphs
+# directory for graphs
 IMG_DIR = "docs/imgs"
-INPUT_DIR = "docs/input"
 os.makedirs(IMG_DIR, exist_ok=True)
-os.makedirs(INPUT_DIR, exist_ok=True)
 
-# list of algorithms: name and menu choice
+# list of algorithms: name, menu choice and benchmark job name
 ALGOS = [
-    {"name": "Quick Search",      "choice": "1"},
-    {"name": "Prime Number Finding", "choice": "2"},
-    {"name": "Bitonic Sort",      "choice": "3"},
-    {"name": "Radix Sort",        "choice": "4"},
-    {"name": "Sample Sort",       "choice": "5"},
+    {"name": "Quick Search",      "choice": "1", "job": "search"},
+    {"name": "Prime Number Finding", "choice": "2", "job": "primes"},
+    {"name": "Bitonic Sort",      "choice": "3", "job": "bitonic"},
+    {"name": "Radix Sort",        "choice": "4", "job": "radix"},
+    {"name": "Sample Sort",       "choice": "5", "job": "sample"},
 ]
 
 # --- helper to round up to next power of two ---
@@ -38,56 +36,46 @@ print("Compiling project…")
 subprocess.run(["bash", "compile.sh"], check=True)
 
 # --- run experiments per algorithm ---
-N_TRIALS = 5  # number of runs per config to average
+N_TRIALS = 5  # timed repetitions per config; the median is plotted
+N_WARMUP = 1  # untimed runs before the repetitions
 
 for algo in ALGOS:
     name = algo["name"]
     choice = algo["choice"]
+    job = algo["job"]
     results = {}
+    # one job per size; the program generates random:N data in [0, N) itself
+    jobs = []
     for size in SIZES:
-        # determine parameters
         if choice in ["1", "3", "4", "5"]:
             N = next_pow2(size)
-            # generate random data file under docs/input
-            datafile = f"{INPUT_DIR}/input_{choice}_{N}.txt"
-            arr = np.random.randint(0, N, size=N)
-            with open(datafile, "w") as f:
-                f.write(" ".join(map(str, arr)))
+            line = f"{job} random:{N} {N_TRIALS} {N_WARMUP}"
+            if choice == "1":
+                line += f" target={np.random.randint(0, N)}"
         else:
             # prime range
-            lower, upper = 1, size
             N = size
+            line = f"{job} 1:{size} {N_TRIALS} {N_WARMUP}"
+        jobs.append(line)
         results[N] = {}
-        # choose processor set per algorithm: Bitonic and Sample use powers of two
-        procs = BITONIC_PROCS if choice in ["3", "5"] else OTHER_PROCS
+    # choose processor set per algorithm: Bitonic and Sample use powers of two
+    procs = BITONIC_PROCS if choice in ["3", "5"] else OTHER_PROCS
+    with tempfile.TemporaryDirectory() as tmp:
+        spec = os.path.join(tmp, "jobs.txt")
+        with open(spec, "w") as f:
+            f.write("\n".join(jobs) + "\n")
         for p in procs:
-            # run multiple trials and compute average time
-            times_list = []
-            for trial in range(N_TRIALS):
-                cmd = ["mpirun", "-np", str(p), EXE]
-                # build stdin for program
-                if choice == "1":
-                    target = np.random.randint(0, N)
-                    inp = "\n".join([choice, datafile, str(target), "N"])
-                elif choice == "2":
-                    inp = "\n".join([choice, str(lower), str(upper), "N"])
-                else:
-                    inp = "\n".join([choice, datafile, "N"])
-                proc = subprocess.run(cmd, input=inp.encode(), stdout=subprocess.PIPE, stderr=subprocess.PIPE, check=True)
-                out = proc.stdout.decode()
-                # parse 'Time Taken: <seconds>' using regex
-                t = None
-                for line in out.splitlines():
-                    m = re.search(r"Time Taken:\s*([0-9]*\.?[0-9]+)", line)
-                    if m:
-                        t = float(m.group(1))
-                        break
-                if t is None:
-                    raise RuntimeError(f"could not parse time from output:\n{out}")
-                times_list.append(t)
-            avg_t = sum(times_list) / len(times_list)
-            results[N][p] = avg_t
-            print(f"{name}: size={N}, p={p}, avg over {N_TRIALS} runs → {avg_t:.6f}s")
+            # every size runs in one MPI session, so start-up is not part of the measurements
+            csv_path = os.path.join(tmp, f"results_{p}.csv")
+            cmd = ["mpirun", "-np", str(p), EXE, "--benchmark", spec,
+                   "--csv", csv_path, "--json", os.path.join(tmp, f"results_{p}.json")]
+            subprocess.run(cmd, stdout=subprocess.PIPE, stderr=subprocess.PIPE, check=True)
+            with open(csv_path) as f:
+                for row in csv.DictReader(f):
+                    N = int(row["elements"])
+                    results[N][p] = float(row["median_s"])
+                    print(f"{name}: size={N}, p={p}, median over {row['repetitions']} runs → {results[N][p]:.6f}s "
+                          f"(min {float(row['min_s']):.6f}s, p95 {float(row['p95_s']):.6f}s)")
 
     # plot results per algorithm
     for N, times in results.items():
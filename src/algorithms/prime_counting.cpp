@@ -0,0 +1,224 @@
+#include "../../include/algorithms/prime_counting.h"
+#include "../../include/algorithms/prime_finding.h"
+#include "../../include/utils/phase_profile.h"
+#include <vector>
+#include <mpi.h>
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+// pi(n) is answered from a table for n below this bound (or below sqrt(x), whichever is larger).
+const long long PI_TABLE_LIMIT = 1LL << 27;
+// phi(x, a) for a up to this many primes comes from a residue table modulo 2*3*5*7*11*13.
+const int PHI_TABLE_PRIMES = 6;
+const long long TABLE_SIEVE_BLOCK = 1 << 22;
+
+struct PrimeCountTables {
+    long long limit;
+    vector<unsigned long long> odd_prime_bits;
+    vector<long long> word_prefix;
+    vector<long long> primes;
+    vector<long long> phi_products;
+    vector<long long> phi_totients;
+    vector<vector<unsigned short>> phi_residues;
+};
+
+static long long integerRoot(long long x, int k) {
+    if (x <= 0)
+        return 0;
+    long long r = (long long)pow((long double)x, 1.0L / k);
+    auto power_exceeds = [&](long long base) {
+        __int128 value = 1;
+        for (int i = 0; i < k; ++i) {
+            value *= base;
+            if (value > x)
+                return true;
+        }
+        return false;
+    };
+    while (r > 0 && power_exceeds(r))
+        r--;
+    while (!power_exceeds(r + 1))
+        r++;
+    return r;
+}
+
+static long long tablePi(long long n, const PrimeCountTables& t) {
+    if (n < 2)
+        return 0;
+    long long k = (n - 1) / 2;
+    long long word = k / 64;
+    unsigned long long mask = (2ULL << (k % 64)) - 1;
+    return 1 + t.word_prefix[word] + __builtin_popcountll(t.odd_prime_bits[word] & mask);
+}
+
+static void buildPhiTables(PrimeCountTables& t) {
+    static const long long first_primes[] = {2, 3, 5, 7, 11, 13};
+    t.phi_products.assign(1, 1);
+    t.phi_totients.assign(1, 1);
+    for (int a = 1; a <= PHI_TABLE_PRIMES; ++a) {
+        t.phi_products.push_back(t.phi_products[a - 1] * first_primes[a - 1]);
+        t.phi_totients.push_back(t.phi_totients[a - 1] * (first_primes[a - 1] - 1));
+    }
+
+    t.phi_residues.assign(PHI_TABLE_PRIMES + 1, vector<unsigned short>());
+    for (int a = 0; a <= PHI_TABLE_PRIMES; ++a) {
+        long long product = t.phi_products[a];
+        t.phi_residues[a].assign(product, 0);
+        unsigned short coprime = 0;
+        for (long long r = 1; r < product; ++r) {
+            bool is_coprime = true;
+            for (int i = 0; i < a; ++i) {
+                if (r % first_primes[i] == 0) {
+                    is_coprime = false;
+                    break;
+                }
+            }
+            if (is_coprime)
+                coprime++;
+            t.phi_residues[a][r] = coprime;
+        }
+    }
+}
+
+// Every rank sieves a word-aligned slice of [0, limit) into an odd-only bitmap,
+// then the slices are exchanged so all ranks hold the full pi(n) table.
+static void buildPrimeCountTables(long long x, int rank, int world_size, MPI_Comm comm, PrimeCountTables& t) {
+    ScopedPhase phase("primecount: tables");
+    long long sqrt_x = integerRoot(x, 2);
+    t.limit = max(sqrt_x + 1, min(x + 1, PI_TABLE_LIMIT));
+
+    long long total_words = t.limit / 128 + 1;
+    long long chunk_size = total_words / world_size;
+    long long remainder = total_words % world_size;
+    vector<int> word_counts(world_size), word_displs(world_size);
+    for (int i = 0; i < world_size; ++i) {
+        word_counts[i] = chunk_size + (i < remainder ? 1 : 0);
+        word_displs[i] = (i == 0) ? 0 : word_displs[i - 1] + word_counts[i - 1];
+    }
+
+    long long first_word = word_displs[rank];
+    vector<unsigned long long> local_bits(word_counts[rank], 0);
+    vector<unsigned int> base_primes = computeBasePrimes(integerRoot(total_words * 128, 2));
+    vector<long long> block_primes;
+    long long slice_start = first_word * 128;
+    long long slice_end = (first_word + word_counts[rank]) * 128 - 1;
+    countPhaseElements(slice_end - slice_start + 1);
+    for (long long lo = slice_start; lo <= slice_end; lo += TABLE_SIEVE_BLOCK) {
+        long long hi = min(slice_end, lo + TABLE_SIEVE_BLOCK - 1);
+        block_primes.clear();
+        segmentedSieveRange(max(lo, 3LL), hi, base_primes, &block_primes);
+        for (long long p : block_primes) {
+            long long k = (p - 1) / 2 - first_word * 64;
+            local_bits[k / 64] |= 1ULL << (k % 64);
+        }
+    }
+
+    t.odd_prime_bits.resize(total_words);
+    MPI_Allgatherv(local_bits.data(), word_counts[rank], MPI_UNSIGNED_LONG_LONG,
+                   t.odd_prime_bits.data(), word_counts.data(), word_displs.data(),
+                   MPI_UNSIGNED_LONG_LONG, comm);
+
+    t.word_prefix.resize(total_words);
+    long long running = 0;
+    for (long long w = 0; w < total_words; ++w) {
+        t.word_prefix[w] = running;
+        running += __builtin_popcountll(t.odd_prime_bits[w]);
+    }
+
+    t.primes.clear();
+    if (sqrt_x >= 2)
+        t.primes.push_back(2);
+    for (long long n = 3; n <= sqrt_x + 1; n += 2) {
+        long long k = (n - 1) / 2;
+        if (t.odd_prime_bits[k / 64] >> (k % 64) & 1)
+            t.primes.push_back(n);
+    }
+
+    buildPhiTables(t);
+}
+
+static long long phi(long long x, long long a, const PrimeCountTables& t) {
+    if (a <= PHI_TABLE_PRIMES) {
+        long long product = t.phi_products[a];
+        return (x / product) * t.phi_totients[a] + t.phi_residues[a][x % product];
+    }
+    long long p = t.primes[a - 1];
+    if (x < p)
+        return (x >= 1) ? 1 : 0;
+    if (x < t.limit && p * p >= x)
+        return tablePi(x, t) - a + 1;
+    return phi(x, a - 1, t) - phi(x / p, a - 1, t);
+}
+
+static long long lehmerPi(long long x, const PrimeCountTables& t);
+
+// Lehmer's formula
+//   pi(x) = phi(x, a) + (b + a - 2)(b - a + 1) / 2 - sum_{a < i <= b} [pi(x / p_i) + sum_{i <= j <= b_i} (pi(x / (p_i p_j)) - (j - 1))]
+// with a = pi(x^1/4), b = pi(x^1/2), c = pi(x^1/3), b_i = pi(sqrt(x / p_i)), the inner sum only for i <= c,
+// and phi(x, a) unrolled as x - sum_{1 <= k <= a} phi(x / p_k, k - 1).
+// Only the terms with index congruent to `part` modulo `parts` are summed, so ranks can split the work.
+static long long lehmerPartial(long long x, const PrimeCountTables& t, int part, int parts) {
+    long long a = lehmerPi(integerRoot(x, 4), t);
+    long long b = lehmerPi(integerRoot(x, 2), t);
+    long long c = lehmerPi(integerRoot(x, 3), t);
+
+    long long sum = 0;
+    if (part == 0) {
+        sum += x + (b + a - 2) * (b - a + 1) / 2;
+    }
+    for (long long k = 1; k <= a; ++k) {
+        if ((k - 1) % parts == part)
+            sum -= phi(x / t.primes[k - 1], k - 1, t);
+    }
+    for (long long i = a + 1; i <= b; ++i) {
+        if ((i - a - 1) % parts != part)
+            continue;
+        long long w = x / t.primes[i - 1];
+        sum -= lehmerPi(w, t);
+        if (i <= c) {
+            long long bi = lehmerPi(integerRoot(w, 2), t);
+            for (long long j = i; j <= bi; ++j) {
+                sum -= lehmerPi(w / t.primes[j - 1], t) - (j - 1);
+            }
+        }
+    }
+    return sum;
+}
+
+static long long lehmerPi(long long x, const PrimeCountTables& t) {
+    if (x < t.limit)
+        return tablePi(x, t);
+    return lehmerPartial(x, t, 0, 1);
+}
+
+static long long distributedPi(long long x, const PrimeCountTables& t, int rank, int world_size, MPI_Comm comm) {
+    if (x < t.limit)
+        return tablePi(x, t);
+    ScopedPhase phase("primecount: lehmer");
+    long long local_sum = lehmerPartial(x, t, rank, world_size);
+    long long global_sum = 0;
+    MPI_Allreduce(&local_sum, &global_sum, 1, MPI_LONG_LONG, MPI_SUM, comm);
+    return global_sum;
+}
+
+long long parallelPrimePi(long long x, int rank, int world_size, MPI_Comm comm) {
+    if (x < 2)
+        return 0;
+    PrimeCountTables tables;
+    buildPrimeCountTables(x, rank, world_size, comm, tables);
+    return distributedPi(x, tables, rank, world_size, comm);
+}
+
+long long parallelPrimeCount(long long lower_bound, long long upper_bound,
+                             int rank, int world_size, MPI_Comm comm) {
+    if (upper_bound < 2 || upper_bound < lower_bound)
+        return 0;
+    PrimeCountTables tables;
+    buildPrimeCountTables(upper_bound, rank, world_size, comm, tables);
+
+    long long upper_pi = distributedPi(upper_bound, tables, rank, world_size, comm);
+    long long lower_pi = (lower_bound > 2) ? distributedPi(lower_bound - 1, tables, rank, world_size, comm) : 0;
+    return upper_pi - lower_pi;
+}
@@ -1,10 +1,59 @@
 #include "../../include/algorithms/prime_finding.h"
+#include "../../include/utils/performance.h"
+#include "../../include/utils/mpi_large_count.h"
+#include "../../include/utils/phase_profile.h"
 #include <vector>
 #include <mpi.h>
 #include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <string>
+#include <iostream>
 
 using namespace std;
 
+// One byte per odd number; 128 KiB keeps a segment resident in L2.
+const unsigned long long SIEVE_SEGMENT_BYTES = 1 << 17;
+// Odd numbers per turn of the 3*5*7 wheel (combined with odd-only storage this is a 2*3*5*7 wheel).
+const int WHEEL_PERIOD = 105;
+const unsigned long long BASE_PRIME_BLOCK = 1 << 24;
+// Compact output files start with an 8-byte magic followed by lower, upper and the prime count (int64 each).
+const MPI_Offset PRIME_FILE_HEADER_BYTES = 32;
+const long long MAX_IO_BYTES = 1 << 30;
+const long long MIN_AUTO_PRIME_CHUNK = 1 << 12;
+const long long PRIME_CHUNKS_PER_RANK = 32;
+// Miller-Rabin windows are pre-sieved with the primes below 2^16 and processed in blocks of this many numbers.
+const unsigned long long MR_PRESIEVE_LIMIT = 1 << 16;
+const long long MR_BLOCK_NUMBERS = 1 << 22;
+
+// What a searched block keeps besides its prime count.
+enum BlockOutput {
+    BLOCK_COUNT,
+    BLOCK_PRIMES,
+    BLOCK_BITSET,
+    BLOCK_GAPS
+};
+
+// `primes` is filled for BLOCK_PRIMES and `bits` (one bit per number from `start`) for BLOCK_BITSET. BLOCK_GAPS
+// keeps the first and last prime and the varint gaps after the first prime; the gap before it depends on the
+// blocks below and is encoded when the file is written.
+struct PrimeBlock {
+    long long start;
+    long long end;
+    long long count;
+    vector<long long> primes;
+    vector<unsigned char> bits;
+    vector<unsigned char> gaps;
+    long long first_prime;
+    long long last_prime;
+};
+
+struct FilePiece {
+    MPI_Offset offset;
+    const unsigned char* data;
+    long long size;
+};
+
 bool isPrime(long long n) {
     if (n <= 1) 
         return false;
@@ -18,38 +67,520 @@ bool isPrime(long long n) {
     return true;
 }
 
-vector<long long> parallelPrimeFinding(long long lower_bound, long long upper_bound,
-                                     int rank, int world_size, MPI_Comm comm) {
-    vector<long long> local_primes;
-    long long total_numbers = upper_bound - lower_bound + 1;
-    
-    if (total_numbers <= 0) 
-        return {};
+static unsigned long long integerSqrt(unsigned long long n) {
+    unsigned long long r = (unsigned long long)sqrtl((long double)n);
+    while (r > 0 && r * r > n)
+        r--;
+    while ((r + 1) * (r + 1) <= n)
+        r++;
+    return r;
+}
+
+static const vector<unsigned char>& wheelPattern() {
+    static vector<unsigned char> pattern;
+    if (pattern.empty()) {
+        pattern.resize(WHEEL_PERIOD);
+        for (int t = 0; t < WHEEL_PERIOD; ++t) {
+            int n = 2 * t + 1;
+            pattern[t] = (n % 3 != 0 && n % 5 != 0 && n % 7 != 0) ? 1 : 0;
+        }
+    }
+    return pattern;
+}
+
+static void appendVarint(vector<unsigned char>& out, unsigned long long value) {
+    while (value >= 0x80) {
+        out.push_back((unsigned char)((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    out.push_back((unsigned char)value);
+}
+
+static int varintSize(unsigned long long value) {
+    int size = 1;
+    while (value >= 0x80) {
+        value >>= 7;
+        size++;
+    }
+    return size;
+}
+
+// Sinks receive the primes of a block in increasing order, one at a time from addPrime() or a sieve segment at
+// a time from addSegment(): one byte per odd number from `low`, 1 for a prime and 0 otherwise.
+struct CountSink {
+    void addPrime(long long) {}
+    void addSegment(unsigned long long, const unsigned char*, size_t) {}
+};
+
+struct ListSink {
+    vector<long long>* primes;
+
+    void addPrime(long long p) {
+        primes->push_back(p);
+    }
+
+    void addSegment(unsigned long long low, const unsigned char* sieve, size_t length) {
+        for (size_t j = 0; j < length; ++j) {
+            if (sieve[j])
+                primes->push_back(low + 2 * j);
+        }
+    }
+};
+
+struct BitsetSink {
+    long long start;
+    vector<unsigned char>* bits;
+
+    void addPrime(long long p) {
+        unsigned long long bit = p - start;
+        (*bits)[bit >> 3] |= (unsigned char)(1 << (bit & 7));
+    }
+
+    void addSegment(unsigned long long low, const unsigned char* sieve, size_t length) {
+        unsigned long long bit = low - start;
+        unsigned char* out = bits->data();
+        for (size_t j = 0; j < length; ++j, bit += 2)
+            out[bit >> 3] |= (unsigned char)(sieve[j] << (bit & 7));
+    }
+};
+
+struct GapSink {
+    PrimeBlock* block;
+
+    void addPrime(long long p) {
+        if (block->last_prime == 0)
+            block->first_prime = p;
+        else
+            appendVarint(block->gaps, p - block->last_prime);
+        block->last_prime = p;
+    }
+
+    void addSegment(unsigned long long low, const unsigned char* sieve, size_t length) {
+        for (size_t j = 0; j < length; ++j) {
+            if (sieve[j])
+                addPrime(low + 2 * j);
+        }
+    }
+};
+
+vector<unsigned int> computeBasePrimes(unsigned long long limit) {
+    vector<unsigned int> primes;
+    if (limit < 2)
+        return primes;
+
+    unsigned long long small_limit = integerSqrt(limit);
+    vector<char> is_composite(small_limit + 1, 0);
+    vector<unsigned int> small_primes;
+    for (unsigned long long i = 2; i <= small_limit; ++i) {
+        if (is_composite[i])
+            continue;
+        small_primes.push_back(i);
+        for (unsigned long long j = i * i; j <= small_limit; j += i) {
+            is_composite[j] = 1;
+        }
+    }
+
+    vector<long long> block_primes;
+    for (unsigned long long lo = 2; lo <= limit; lo += BASE_PRIME_BLOCK) {
+        unsigned long long hi = min(limit, lo + BASE_PRIME_BLOCK - 1);
+        block_primes.clear();
+        segmentedSieveRange(lo, hi, small_primes, &block_primes);
+        primes.insert(primes.end(), block_primes.begin(), block_primes.end());
+    }
+    return primes;
+}
+
+template<typename Sink>
+static long long sieveRange(long long start, long long end, const vector<unsigned int>& base_primes, Sink& sink) {
+    long long count = 0;
+    if (start < 2)
+        start = 2;
+    if (end < start)
+        return 0;
+
+    if (start == 2) {
+        count++;
+        sink.addPrime(2);
+        start = 3;
+    }
+
+    unsigned long long low = (start % 2 == 0) ? start + 1 : start;
+    unsigned long long high = end;
+    if (low > high)
+        return count;
+
+    size_t first_sieving = 0;
+    while (first_sieving < base_primes.size() && base_primes[first_sieving] <= 7) {
+        first_sieving++;
+    }
+    size_t active = first_sieving;
+    vector<unsigned long long> next_multiple;
+
+    const vector<unsigned char>& pattern = wheelPattern();
+    vector<unsigned char> sieve(SIEVE_SEGMENT_BYTES);
+
+    for (unsigned long long seg_low = low; seg_low <= high; ) {
+        size_t seg_len = min(SIEVE_SEGMENT_BYTES, (high - seg_low) / 2 + 1);
+        unsigned long long seg_high = seg_low + 2 * (seg_len - 1);
+
+        size_t offset = ((seg_low - 1) / 2) % WHEEL_PERIOD;
+        for (size_t filled = 0; filled < seg_len; ) {
+            size_t chunk = min((size_t)WHEEL_PERIOD - offset, seg_len - filled);
+            memcpy(&sieve[filled], &pattern[offset], chunk);
+            filled += chunk;
+            offset = 0;
+        }
+        for (unsigned long long small : {1ULL, 3ULL, 5ULL, 7ULL}) {
+            if (small >= seg_low && small <= seg_high) {
+                sieve[(small - seg_low) / 2] = (small != 1);
+            }
+        }
+
+        while (active < base_primes.size() &&
+               (unsigned long long)base_primes[active] * base_primes[active] <= seg_high) {
+            unsigned long long p = base_primes[active];
+            unsigned long long m = max(p * p, (seg_low + p - 1) / p * p);
+            if (m % 2 == 0)
+                m += p;
+            next_multiple.push_back(m);
+            active++;
+        }
+
+        for (size_t i = first_sieving; i < active; ++i) {
+            unsigned long long m = next_multiple[i - first_sieving];
+            if (m > seg_high)
+                continue;
+            size_t p = base_primes[i];
+            size_t j = (m - seg_low) / 2;
+            for (; j < seg_len; j += p) {
+                sieve[j] = 0;
+            }
+            next_multiple[i - first_sieving] = seg_low + 2 * (unsigned long long)j;
+        }
+
+        sink.addSegment(seg_low, sieve.data(), seg_len);
+        for (size_t j = 0; j < seg_len; ++j) {
+            count += sieve[j];
+        }
+
+        seg_low = seg_high + 2;
+    }
+    return count;
+}
+
+long long segmentedSieveRange(long long start, long long end,
+                              const vector<unsigned int>& base_primes, vector<long long>* out_primes) {
+    if (out_primes) {
+        ListSink sink = {out_primes};
+        return sieveRange(start, end, base_primes, sink);
+    }
+    CountSink sink;
+    return sieveRange(start, end, base_primes, sink);
+}
+
+struct Montgomery64 {
+    unsigned long long n;
+    unsigned long long n_inv;
+    unsigned long long r2;
+
+    explicit Montgomery64(unsigned long long modulus) : n(modulus), n_inv(modulus) {
+        for (int i = 0; i < 5; ++i) {
+            n_inv *= 2 - n * n_inv;
+        }
+        unsigned long long r = (0 - n) % n;
+        r2 = (unsigned long long)((unsigned __int128)r * r % n);
+    }
+
+    unsigned long long reduce(unsigned __int128 t) const {
+        unsigned long long m = (unsigned long long)t * n_inv;
+        unsigned long long t_high = (unsigned long long)(t >> 64);
+        unsigned long long mn_high = (unsigned long long)(((unsigned __int128)m * n) >> 64);
+        return (t_high >= mn_high) ? t_high - mn_high : t_high + (n - mn_high);
+    }
+
+    unsigned long long multiply(unsigned long long a, unsigned long long b) const {
+        return reduce((unsigned __int128)a * b);
+    }
+
+    unsigned long long toMontgomery(unsigned long long a) const {
+        return multiply(a % n, r2);
+    }
+
+    unsigned long long power(unsigned long long base, unsigned long long exponent) const {
+        unsigned long long result = toMontgomery(1);
+        while (exponent > 0) {
+            if (exponent & 1)
+                result = multiply(result, base);
+            base = multiply(base, base);
+            exponent >>= 1;
+        }
+        return result;
+    }
+};
+
+bool millerRabinIsPrime(unsigned long long n) {
+    static const unsigned long long small_primes[] = {2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37};
+    // Deterministic for every n < 2^64 (Sinclair's witness set).
+    static const unsigned long long witnesses[] = {2, 325, 9375, 28178, 450775, 9780504, 1795265022};
+
+    if (n < 2)
+        return false;
+    for (unsigned long long p : small_primes) {
+        if (n % p == 0)
+            return n == p;
+    }
+
+    unsigned long long d = n - 1;
+    int s = 0;
+    while ((d & 1) == 0) {
+        d >>= 1;
+        s++;
+    }
+
+    Montgomery64 mont(n);
+    unsigned long long one = mont.toMontgomery(1);
+    unsigned long long minus_one = mont.toMontgomery(n - 1);
+    for (unsigned long long a : witnesses) {
+        a %= n;
+        if (a == 0)
+            continue;
+        unsigned long long x = mont.power(mont.toMontgomery(a), d);
+        if (x == one || x == minus_one)
+            continue;
+        bool composite = true;
+        for (int r = 1; r < s; ++r) {
+            x = mont.multiply(x, x);
+            if (x == minus_one) {
+                composite = false;
+                break;
+            }
+        }
+        if (composite)
+            return false;
+    }
+    return true;
+}
+
+template<typename Sink>
+static long long millerRabinRange(long long start, long long end, const vector<unsigned int>& small_primes,
+                                  Sink& sink) {
+    // A survivor of the pre-sieve below (q+1)^2 has no factor up to q, so only larger ones need the test.
+    unsigned long long largest = small_primes.empty() ? 1 : small_primes.back();
+    unsigned long long proven_below = (largest + 1) * (largest + 1);
+
+    long long count = 0;
+    vector<long long> candidates;
+    for (long long block_start = start; block_start <= end; ) {
+        long long block_end = (end - block_start < MR_BLOCK_NUMBERS) ? end : block_start + MR_BLOCK_NUMBERS - 1;
+        candidates.clear();
+        segmentedSieveRange(block_start, block_end, small_primes, &candidates);
+        for (long long n : candidates) {
+            if ((unsigned long long)n < proven_below || millerRabinIsPrime(n)) {
+                count++;
+                sink.addPrime(n);
+            }
+        }
+        if (block_end == end)
+            break;
+        block_start = block_end + 1;
+    }
+    return count;
+}
+
+static PrimeEngine resolvePrimeEngine(PrimeEngine engine, long long lower_bound, long long upper_bound) {
+    if (engine != PRIME_ENGINE_AUTO)
+        return engine;
+    unsigned long long sqrt_upper = (upper_bound > 0) ? integerSqrt(upper_bound) : 0;
+    unsigned long long window = upper_bound - lower_bound + 1;
+    return (window < sqrt_upper) ? PRIME_ENGINE_MILLER_RABIN : PRIME_ENGINE_SIEVE;
+}
+
+static vector<unsigned int> broadcastBasePrimes(unsigned long long limit, int rank, MPI_Comm comm) {
+    ScopedPhase phase("primes: base primes");
+    vector<unsigned int> base_primes;
+    long long base_count = 0;
+    if (rank == 0) {
+        base_primes = computeBasePrimes(limit);
+        base_count = base_primes.size();
+    }
+    MPI_Bcast(&base_count, 1, MPI_LONG_LONG, 0, comm);
+    base_primes.resize(base_count);
+    MPI_Bcast(base_primes.data(), (int)base_count, MPI_UNSIGNED, 0, comm);
+    return base_primes;
+}
 
-    long long chunk_size = total_numbers / world_size;
-    long long remainder = total_numbers % world_size;
+static void computeRankBlock(long long lower_bound, long long upper_bound, int rank, int world_size,
+                             long long align, long long& my_start, long long& my_end) {
+    long long total_units = (upper_bound - lower_bound + align) / align;
+    long long chunk_size = total_units / world_size;
+    long long remainder = total_units % world_size;
 
-    long long my_start = lower_bound + rank * chunk_size + min((long long)rank, remainder);
-    long long my_end = my_start + chunk_size + (rank < remainder ? 1 : 0) -1;
+    long long start_unit = rank * chunk_size + min((long long)rank, remainder);
+    long long end_unit = start_unit + chunk_size + (rank < remainder ? 1 : 0);
 
-    for (long long i = my_start; i <= my_end; ++i) {
+    my_start = lower_bound + start_unit * align;
+    my_end = min(upper_bound, lower_bound + end_unit * align - 1);
+}
+
+template<typename Sink>
+static long long findPrimesInBlock(long long start, long long end, PrimeEngine engine,
+                                   const vector<unsigned int>& base_primes, Sink& sink) {
+    if (engine == PRIME_ENGINE_SIEVE) {
+        return sieveRange(start, end, base_primes, sink);
+    }
+    if (engine == PRIME_ENGINE_MILLER_RABIN) {
+        return millerRabinRange(start, end, base_primes, sink);
+    }
+    long long count = 0;
+    for (long long i = start; i <= end; ++i) {
         if (isPrime(i)) {
-            local_primes.push_back(i);
+            count++;
+            sink.addPrime(i);
         }
     }
+    return count;
+}
+
+// Searches [block.start, block.end] and builds the block's output straight from the engine, so the bitset and
+// gap outputs never hold the primes themselves.
+static void searchBlock(PrimeBlock& block, PrimeEngine engine, const vector<unsigned int>& base_primes,
+                        BlockOutput output) {
+    ScopedPhase phase("primes: block search");
+    countPhaseElements(max(0LL, block.end - block.start + 1));
+    block.first_prime = block.last_prime = 0;
+    if (output == BLOCK_PRIMES) {
+        ListSink sink = {&block.primes};
+        block.count = findPrimesInBlock(block.start, block.end, engine, base_primes, sink);
+    } else if (output == BLOCK_BITSET) {
+        if (block.start <= block.end)
+            block.bits.assign((block.end - block.start + 8) / 8, 0);
+        BitsetSink sink = {block.start, &block.bits};
+        block.count = findPrimesInBlock(block.start, block.end, engine, base_primes, sink);
+    } else if (output == BLOCK_GAPS) {
+        GapSink sink = {&block};
+        block.count = findPrimesInBlock(block.start, block.end, engine, base_primes, sink);
+    } else {
+        CountSink sink;
+        block.count = findPrimesInBlock(block.start, block.end, engine, base_primes, sink);
+    }
+}
+
+static void allgatherBlockFields(const vector<long long>& local_fields, vector<long long>& all_fields,
+                                 int world_size, MPI_Comm comm) {
+    int local_len = local_fields.size();
+    vector<int> recv_counts(world_size), displs(world_size);
+    MPI_Allgather(&local_len, 1, MPI_INT, recv_counts.data(), 1, MPI_INT, comm);
+
+    int total_len = 0;
+    for (int i = 0; i < world_size; ++i) {
+        displs[i] = total_len;
+        total_len += recv_counts[i];
+    }
+    all_fields.resize(total_len);
+    MPI_Allgatherv(local_fields.data(), local_len, MPI_LONG_LONG,
+                   all_fields.data(), recv_counts.data(), displs.data(), MPI_LONG_LONG, comm);
+}
+
+static vector<PrimeBlock> findLocalPrimeBlocks(long long lower_bound, long long upper_bound,
+                                               int rank, int world_size, MPI_Comm comm,
+                                               const PrimeFindingOptions& options, long long align,
+                                               BlockOutput output) {
+    PrimeEngine engine = resolvePrimeEngine(options.engine, lower_bound, upper_bound);
+    unsigned long long sqrt_upper = (upper_bound > 0) ? integerSqrt(upper_bound) : 0;
+    vector<unsigned int> base_primes;
+    if (engine == PRIME_ENGINE_SIEVE) {
+        base_primes = broadcastBasePrimes(sqrt_upper, rank, comm);
+    } else if (engine == PRIME_ENGINE_MILLER_RABIN) {
+        base_primes = broadcastBasePrimes(min(sqrt_upper, MR_PRESIEVE_LIMIT), rank, comm);
+    }
+
+    vector<PrimeBlock> blocks;
+    double busy_time = 0.0;
 
-    int local_size = local_primes.size();
-    vector<int> recv_counts;
-    if (rank == 0) 
+    if (options.schedule == PRIME_SCHEDULE_DYNAMIC) {
+        long long total_numbers = upper_bound - lower_bound + 1;
+        long long chunk_size = options.chunk_size;
+        if (chunk_size <= 0) {
+            chunk_size = max(MIN_AUTO_PRIME_CHUNK, total_numbers / (world_size * PRIME_CHUNKS_PER_RANK));
+        }
+        chunk_size = (chunk_size + align - 1) / align * align;
+        long long num_chunks = (total_numbers + chunk_size - 1) / chunk_size;
+
+        // Shared chunk counter on rank 0; every rank (rank 0 included) claims the next chunk with MPI_Fetch_and_op.
+        long long* next_chunk = nullptr;
+        MPI_Win win;
+        MPI_Win_allocate((rank == 0) ? sizeof(long long) : 0, sizeof(long long), MPI_INFO_NULL, comm, &next_chunk, &win);
+        if (rank == 0) {
+            MPI_Win_lock(MPI_LOCK_EXCLUSIVE, 0, 0, win);
+            *next_chunk = 0;
+            MPI_Win_unlock(0, win);
+        }
+        MPI_Barrier(comm);
+
+        MPI_Win_lock_all(0, win);
+        const long long one = 1;
+        while (true) {
+            long long chunk_index = 0;
+            MPI_Fetch_and_op(&one, &chunk_index, MPI_LONG_LONG, 0, 0, MPI_SUM, win);
+            MPI_Win_flush(0, win);
+            if (chunk_index >= num_chunks)
+                break;
+
+            PrimeBlock block;
+            block.start = lower_bound + chunk_index * chunk_size;
+            block.end = min(upper_bound, block.start + chunk_size - 1);
+            double busy_start = MPI_Wtime();
+            searchBlock(block, engine, base_primes, output);
+            busy_time += MPI_Wtime() - busy_start;
+            blocks.push_back(move(block));
+        }
+        MPI_Win_unlock_all(win);
+        MPI_Win_free(&win);
+    } else {
+        PrimeBlock block;
+        computeRankBlock(lower_bound, upper_bound, rank, world_size, align, block.start, block.end);
+        double busy_start = MPI_Wtime();
+        searchBlock(block, engine, base_primes, output);
+        busy_time += MPI_Wtime() - busy_start;
+        blocks.push_back(move(block));
+    }
+
+    if (options.report_busy_time) {
+        reportPerRankTimes("Prime Finding Busy Time", busy_time, blocks.size(), rank, world_size, comm);
+    }
+    return blocks;
+}
+
+vector<long long> parallelPrimeFinding(long long lower_bound, long long upper_bound,
+                                     int rank, int world_size, MPI_Comm comm, const PrimeFindingOptions& options) {
+    vector<long long> local_primes;
+    long long total_numbers = upper_bound - lower_bound + 1;
+
+    if (total_numbers <= 0)
+        return {};
+
+    vector<PrimeBlock> blocks = findLocalPrimeBlocks(lower_bound, upper_bound, rank, world_size, comm,
+                                                     options, 1, BLOCK_PRIMES);
+    vector<long long> local_layout;
+    for (const PrimeBlock& block : blocks) {
+        local_primes.insert(local_primes.end(), block.primes.begin(), block.primes.end());
+        local_layout.push_back(block.start);
+        local_layout.push_back(block.count);
+    }
+
+    ScopedPhase phase("primes: gather");
+    long long local_size = local_primes.size();
+    vector<long long> recv_counts;
+    if (rank == 0)
         recv_counts.resize(world_size);
 
-    MPI_Gather(&local_size, 1, MPI_INT, (rank == 0) ? recv_counts.data() : nullptr, 1, MPI_INT, 0, comm);
+    MPI_Gather(&local_size, 1, MPI_LONG_LONG, (rank == 0) ? recv_counts.data() : nullptr, 1, MPI_LONG_LONG, 0, comm);
 
     vector<long long> global_primes;
-    vector<int> displs;
+    vector<long long> displs;
     if (rank == 0) {
         displs.resize(world_size);
-        int total_gathered_primes = 0;
+        long long total_gathered_primes = 0;
         for (int i = 0; i < world_size; ++i) {
             displs[i] = (i == 0) ? 0 : displs[i - 1] + recv_counts[i - 1];
             total_gathered_primes += recv_counts[i];
@@ -57,14 +588,208 @@ vector<long long> parallelPrimeFinding(long long lower_bound, long long upper_bo
         global_primes.resize(total_gathered_primes);
     }
 
-    MPI_Gatherv(local_primes.data(), local_size, MPI_LONG_LONG,
-                (rank == 0) ? global_primes.data() : nullptr,
-                (rank == 0) ? recv_counts.data() : nullptr,
-                (rank == 0) ? displs.data() : nullptr,
-                MPI_LONG_LONG, 0, comm);
+    largeGatherv(local_primes.data(), local_size, global_primes.data(), recv_counts, displs,
+                 MPI_LONG_LONG, 0, comm);
+
+    if (options.schedule == PRIME_SCHEDULE_DYNAMIC) {
+        // Chunks arrive grouped by rank; put them back in range order.
+        vector<long long> all_layout;
+        allgatherBlockFields(local_layout, all_layout, world_size, comm);
+        if (rank == 0) {
+            vector<pair<long long, size_t>> chunk_order;
+            for (size_t i = 0; i < all_layout.size(); i += 2) {
+                chunk_order.push_back(make_pair(all_layout[i], i));
+            }
+            sort(chunk_order.begin(), chunk_order.end());
+
+            vector<long long> chunk_offsets(all_layout.size() / 2);
+            long long source_offset = 0;
+            for (size_t i = 0; i < all_layout.size(); i += 2) {
+                chunk_offsets[i / 2] = source_offset;
+                source_offset += all_layout[i + 1];
+            }
+
+            vector<long long> ordered_primes;
+            ordered_primes.reserve(global_primes.size());
+            for (const pair<long long, size_t>& chunk : chunk_order) {
+                auto first = global_primes.begin() + chunk_offsets[chunk.second / 2];
+                ordered_primes.insert(ordered_primes.end(), first, first + all_layout[chunk.second + 1]);
+            }
+            global_primes.swap(ordered_primes);
+        }
+    }
 
     if (rank == 0) {
         return global_primes;
     }
     return {};
-}
\ No newline at end of file
+}
+
+static bool openPrimeFile(const string& filename, MPI_Comm comm, MPI_File& fh) {
+    int err = MPI_File_open(comm, filename.c_str(), MPI_MODE_CREATE | MPI_MODE_WRONLY, MPI_INFO_NULL, &fh);
+    return err == MPI_SUCCESS;
+}
+
+static void writePrimeFileHeader(MPI_File fh, const char* magic, long long lower_bound, long long upper_bound,
+                                 long long prime_count, int rank) {
+    if (rank != 0)
+        return;
+    unsigned char header[PRIME_FILE_HEADER_BYTES];
+    long long fields[3] = {lower_bound, upper_bound, prime_count};
+    memcpy(header, magic, 8);
+    memcpy(header + 8, fields, sizeof(fields));
+    MPI_File_write_at(fh, 0, header, PRIME_FILE_HEADER_BYTES, MPI_BYTE, MPI_STATUS_IGNORE);
+}
+
+// Every rank issues the same number of collective writes, padding with empty ones,
+// so ranks with different numbers of pieces still take part in each MPI_File_write_at_all.
+static void writePiecesCollective(MPI_File fh, const vector<FilePiece>& pieces, MPI_Comm comm) {
+    vector<FilePiece> split;
+    for (const FilePiece& piece : pieces) {
+        for (long long done = 0; done < piece.size; done += MAX_IO_BYTES) {
+            FilePiece part = {piece.offset + done, piece.data + done, min(MAX_IO_BYTES, piece.size - done)};
+            split.push_back(part);
+        }
+    }
+
+    long long local_writes = split.size();
+    long long max_writes = 0;
+    MPI_Allreduce(&local_writes, &max_writes, 1, MPI_LONG_LONG, MPI_MAX, comm);
+
+    unsigned char dummy = 0;
+    for (long long i = 0; i < max_writes; ++i) {
+        if (i < local_writes) {
+            MPI_File_write_at_all(fh, split[i].offset, split[i].data, (int)split[i].size,
+                                  MPI_BYTE, MPI_STATUS_IGNORE);
+        } else {
+            MPI_File_write_at_all(fh, 0, &dummy, 0, MPI_BYTE, MPI_STATUS_IGNORE);
+        }
+    }
+}
+
+static bool writePrimeBitset(const string& filename, long long lower_bound, long long upper_bound,
+                             long long prime_count, const vector<PrimeBlock>& blocks, int rank, MPI_Comm comm) {
+    MPI_File fh;
+    if (!openPrimeFile(filename, comm, fh))
+        return false;
+
+    MPI_File_set_size(fh, PRIME_FILE_HEADER_BYTES + (upper_bound - lower_bound + 8) / 8);
+    writePrimeFileHeader(fh, "PRIMEBIT", lower_bound, upper_bound, prime_count, rank);
+
+    vector<FilePiece> pieces;
+    for (const PrimeBlock& block : blocks) {
+        if (block.start > block.end)
+            continue;
+        FilePiece piece = {PRIME_FILE_HEADER_BYTES + (block.start - lower_bound) / 8,
+                           block.bits.data(), (long long)block.bits.size()};
+        pieces.push_back(piece);
+    }
+    writePiecesCollective(fh, pieces, comm);
+
+    MPI_File_close(&fh);
+    return true;
+}
+
+// Every rank learns (start, count, first prime, last prime, gap bytes) of every block and walks the blocks in
+// range order once: a block's first gap is measured from the last prime below it (or from lower_bound), and its
+// offset is the size of everything encoded before it.
+static bool writePrimeDeltas(const string& filename, long long lower_bound, long long upper_bound,
+                             long long prime_count, const vector<PrimeBlock>& blocks,
+                             int rank, int world_size, MPI_Comm comm) {
+    const size_t FIELDS = 5;
+    vector<long long> local_fields;
+    for (const PrimeBlock& block : blocks) {
+        local_fields.push_back(block.start);
+        local_fields.push_back(block.count);
+        local_fields.push_back(block.first_prime);
+        local_fields.push_back(block.last_prime);
+        local_fields.push_back(block.gaps.size());
+    }
+    vector<long long> all_fields;
+    allgatherBlockFields(local_fields, all_fields, world_size, comm);
+
+    size_t block_count = all_fields.size() / FIELDS;
+    vector<pair<long long, size_t>> order(block_count);
+    for (size_t i = 0; i < block_count; ++i) {
+        order[i] = make_pair(all_fields[i * FIELDS], i);
+    }
+    sort(order.begin(), order.end());
+
+    vector<long long> sorted_starts(block_count), previous_primes(block_count);
+    vector<MPI_Offset> offsets(block_count);
+    MPI_Offset offset = PRIME_FILE_HEADER_BYTES;
+    long long previous = lower_bound;
+    for (size_t k = 0; k < block_count; ++k) {
+        const long long* fields = &all_fields[order[k].second * FIELDS];
+        sorted_starts[k] = fields[0];
+        previous_primes[k] = previous;
+        offsets[k] = offset;
+        if (fields[1] > 0) {
+            offset += varintSize(fields[2] - previous) + fields[4];
+            previous = fields[3];
+        }
+    }
+
+    MPI_File fh;
+    if (!openPrimeFile(filename, comm, fh))
+        return false;
+
+    MPI_File_set_size(fh, offset);
+    writePrimeFileHeader(fh, "PRIMEDLT", lower_bound, upper_bound, prime_count, rank);
+
+    vector<vector<unsigned char>> first_gaps(blocks.size());
+    vector<FilePiece> pieces;
+    for (size_t b = 0; b < blocks.size(); ++b) {
+        const PrimeBlock& block = blocks[b];
+        if (block.count == 0)
+            continue;
+        size_t k = std::lower_bound(sorted_starts.begin(), sorted_starts.end(), block.start) - sorted_starts.begin();
+        appendVarint(first_gaps[b], block.first_prime - previous_primes[k]);
+        FilePiece head = {offsets[k], first_gaps[b].data(), (long long)first_gaps[b].size()};
+        FilePiece rest = {offsets[k] + (MPI_Offset)first_gaps[b].size(), block.gaps.data(),
+                          (long long)block.gaps.size()};
+        pieces.push_back(head);
+        pieces.push_back(rest);
+    }
+    writePiecesCollective(fh, pieces, comm);
+
+    MPI_File_close(&fh);
+    return true;
+}
+
+long long parallelPrimeFindingCompact(long long lower_bound, long long upper_bound,
+                                      int rank, int world_size, MPI_Comm comm,
+                                      PrimeResultMode mode, const string& output_filename,
+                                      const PrimeFindingOptions& options) {
+    long long total_numbers = upper_bound - lower_bound + 1;
+    if (total_numbers <= 0)
+        return 0;
+
+    // Byte-aligned blocks let every rank own whole bytes of the bitset.
+    BlockOutput output = (mode == PRIME_RESULT_BITSET) ? BLOCK_BITSET : (mode == PRIME_RESULT_DELTA) ? BLOCK_GAPS
+                                                                                                   : BLOCK_COUNT;
+    vector<PrimeBlock> blocks = findLocalPrimeBlocks(lower_bound, upper_bound, rank, world_size, comm,
+                                                     options, 8, output);
+
+    long long local_count = 0;
+    for (const PrimeBlock& block : blocks) {
+        local_count += block.count;
+    }
+    long long global_count = 0;
+    MPI_Allreduce(&local_count, &global_count, 1, MPI_LONG_LONG, MPI_SUM, comm);
+
+    bool written = true;
+    if (output != BLOCK_COUNT) {
+        ScopedPhase phase("primes: write");
+        if (mode == PRIME_RESULT_BITSET) {
+            written = writePrimeBitset(output_filename, lower_bound, upper_bound, global_count, blocks, rank, comm);
+        } else {
+            written = writePrimeDeltas(output_filename, lower_bound, upper_bound, global_count, blocks,
+                                       rank, world_size, comm);
+        }
+    }
+    if (!written && rank == 0) {
+        cout << "Error: Could not open output file: " << output_filename << endl;
+    }
+    return global_count;
+}
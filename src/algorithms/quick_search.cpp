@@ -1,62 +1,168 @@
 #include "../../include/algorithms/quick_search.h"
+#include "../../include/algorithms/radix_sort.h"
+#include "../../include/utils/sort_types.h"
+#include "../../include/utils/scan_kernels.h"
+#include "../../include/utils/mpi_large_count.h"
+#include "../../include/utils/phase_profile.h"
 #include <vector>
 #include <utility>
+#include <algorithm>
+#include <climits>
 #include <mpi.h>
 
 using namespace std;
 
-pair<bool, int> parallelQuickSearch(const vector<int>& local_data, int target_value,
-                                    int global_data_size, int rank, int world_size, MPI_Comm comm) {
-    bool local_found = false;
-    int local_idx = -1;
-    int global_idx_offset = 0;
+// Index reported by a rank that does not hold the value, so the minimum over ranks is the first occurrence.
+const long long NOT_FOUND_INDEX = LLONG_MAX;
+// Elements (4 MB) scanned between two checks of whether a lower rank has already found the target.
+const size_t SCAN_BLOCK = 1 << 20;
 
-    int chunk_size = global_data_size / world_size;
-    int remainder = global_data_size % world_size;
+static long long globalOffset(long long local_size, int rank, MPI_Comm comm) {
+    long long offset = 0;
+    MPI_Exscan(&local_size, &offset, 1, MPI_LONG_LONG, MPI_SUM, comm);
+    return (rank == 0) ? 0 : offset;
+}
+
+// The lowest global index found so far lives in a window on rank 0 and is updated with one-sided atomics.
+// The slice is scanned in blocks, and before each block a rank reads that index: once a lower rank has found
+// the target, nothing this rank holds can be the first occurrence, so it stops without finishing its slice.
+pair<bool, long long> parallelQuickSearch(const vector<int>& local_data, int target_value,
+                                          long long global_data_size, int rank, int world_size, MPI_Comm comm,
+                                          long long* elements_scanned) {
+    long long local_idx = NOT_FOUND_INDEX;
+    long long global_idx_offset = 0;
+
+    long long chunk_size = global_data_size / world_size;
+    long long remainder = global_data_size % world_size;
     for(int i = 0; i < rank; ++i) {
         global_idx_offset += chunk_size + (i < remainder ? 1 : 0);
     }
 
-    for (size_t i = 0; i < local_data.size(); ++i) {
-        if (local_data[i] == target_value) {
-            local_found = true;
-            local_idx = global_idx_offset + i;
+    long long* best_index = nullptr;
+    MPI_Win best_win;
+    MPI_Win_allocate((rank == 0) ? sizeof(long long) : 0, sizeof(long long), MPI_INFO_NULL, comm, &best_index, &best_win);
+    if (rank == 0)
+        *best_index = NOT_FOUND_INDEX;
+    MPI_Barrier(comm);
+    MPI_Win_lock_all(MPI_MODE_NOCHECK, best_win);
+
+    ScopedPhase scan_phase("search: scan");
+    long long scanned = 0;
+    for (size_t start = 0; start < local_data.size(); start += SCAN_BLOCK) {
+        if (global_idx_offset > 0) {
+            long long best_so_far = NOT_FOUND_INDEX;
+            MPI_Fetch_and_op(nullptr, &best_so_far, MPI_LONG_LONG, 0, 0, MPI_NO_OP, best_win);
+            MPI_Win_flush(0, best_win);
+            if (best_so_far < global_idx_offset)
+                break;
+        }
+        size_t len = min(SCAN_BLOCK, local_data.size() - start);
+        size_t pos = scanFirstEqual(local_data.data() + start, len, target_value);
+        scanned += (pos < len) ? pos + 1 : len;
+        if (pos < len) {
+            local_idx = global_idx_offset + start + pos;
+            long long previous;
+            MPI_Fetch_and_op(&local_idx, &previous, MPI_LONG_LONG, 0, 0, MPI_MIN, best_win);
+            MPI_Win_flush(0, best_win);
             break;
         }
     }
+    MPI_Win_unlock_all(best_win);
+    countPhaseElements(scanned);
+    scan_phase.close();
 
-    struct {
-        int found_flag;
-        int index;
-    } local_res, global_res;
+    ScopedPhase phase("search: combine");
+    long long first_idx = NOT_FOUND_INDEX;
+    MPI_Reduce(&local_idx, &first_idx, 1, MPI_LONG_LONG, MPI_MIN, 0, comm);
+    if (elements_scanned != nullptr)
+        MPI_Reduce(&scanned, elements_scanned, 1, MPI_LONG_LONG, MPI_SUM, 0, comm);
+    MPI_Win_free(&best_win);
 
-    local_res.found_flag = local_found ? 1 : 0;
-    local_res.index = local_found ? local_idx : global_data_size + 1;
+    if (rank == 0 && first_idx != NOT_FOUND_INDEX) {
+        return {true, first_idx};
+    }
+    return {false, -1};
+}
 
-    MPI_Reduce(&local_res, &global_res, 1, MPI_2INT, MPI_MINLOC, 0, comm);
+// The (value, position) records are radix sorted, which is stable, so the first record of each run of equal
+// values carries that value's first position.
+SearchIndex buildSearchIndex(const vector<int>& local_data, int rank, MPI_Comm comm) {
+    ScopedPhase phase("search: build index");
+    countPhaseElements(local_data.size());
+    long long offset = globalOffset(local_data.size(), rank, comm);
 
-    int found_data[2];
-    found_data[0] = local_found ? 1 : 0;
-    found_data[1] = local_idx;
+    vector<IntIndexRecord> records(local_data.size());
+    for (size_t i = 0; i < local_data.size(); ++i)
+        records[i] = {local_data[i], offset + (long long)i};
+    localRadixSort(records);
 
-    vector<int> all_results_flat;
-    if (rank == 0) {
-        all_results_flat.resize(2 * world_size);
+    SearchIndex index;
+    for (size_t i = 0; i < records.size(); ++i) {
+        if (i > 0 && records[i].key == records[i - 1].key)
+            continue;
+        index.values.push_back(records[i].key);
+        index.first_index.push_back(records[i].payload);
     }
-    MPI_Gather(found_data, 2, MPI_INT, all_results_flat.data(), 2, MPI_INT, 0, comm);
+    return index;
+}
 
-    if (rank == 0) {
-        bool final_found = false;
-        int final_idx = -1;
-        for (int i = 0; i < world_size; ++i) {
-            if (all_results_flat[i * 2] == 1) {
-                if (!final_found || all_results_flat[i * 2 + 1] < final_idx) {
-                    final_found = true;
-                    final_idx = all_results_flat[i * 2 + 1];
-                }
-            }
-        }
-        return {final_found, final_idx};
+// Every rank must hold the same targets. Each rank looks all of them up in its own index and a single
+// MPI_Reduce(MIN) combines the answers, so the root gets the global first index of every target (-1 if absent).
+vector<long long> parallelBatchSearch(const SearchIndex& index, const vector<int>& targets,
+                                      int root_rank, int rank, MPI_Comm comm) {
+    ScopedPhase phase("search: batch lookup");
+    countPhaseElements(targets.size());
+    vector<long long> local_first(targets.size(), NOT_FOUND_INDEX);
+    for (size_t t = 0; t < targets.size(); ++t) {
+        size_t pos = lower_bound(index.values.begin(), index.values.end(), targets[t]) - index.values.begin();
+        if (pos < index.values.size() && index.values[pos] == targets[t])
+            local_first[t] = index.first_index[pos];
     }
-    return {false, -1};
-}
\ No newline at end of file
+
+    vector<long long> first(rank == root_rank ? targets.size() : 0);
+    MPI_Reduce(local_first.data(), first.data(), targets.size(), MPI_LONG_LONG, MPI_MIN, root_rank, comm);
+    for (long long& idx : first) {
+        if (idx == NOT_FOUND_INDEX)
+            idx = -1;
+    }
+    return first;
+}
+
+// Counts every occurrence with the vector count kernel. When `occurrences` is given, each rank also lists the
+// global indices of its matches and the root gathers them, already in ascending order since ranks hold
+// consecutive blocks. Returns the total count on the root.
+long long parallelFindAll(const vector<int>& local_data, int target_value, int root_rank, int rank, int world_size,
+                          MPI_Comm comm, vector<long long>* occurrences) {
+    ScopedPhase count_phase("search: count");
+    countPhaseElements(local_data.size());
+    long long local_count = scanCountEqual(local_data.data(), local_data.size(), target_value);
+    long long total_count = 0;
+    MPI_Reduce(&local_count, &total_count, 1, MPI_LONG_LONG, MPI_SUM, root_rank, comm);
+    count_phase.close();
+    if (occurrences == nullptr)
+        return total_count;
+
+    ScopedPhase phase("search: gather indices");
+    long long offset = globalOffset(local_data.size(), rank, comm);
+    vector<long long> local_indices;
+    local_indices.reserve(local_count);
+    const int* data = local_data.data();
+    size_t n = local_data.size();
+    for (size_t pos = scanFirstEqual(data, n, target_value); pos < n;
+         pos += 1 + scanFirstEqual(data + pos + 1, n - pos - 1, target_value))
+        local_indices.push_back(offset + pos);
+
+    vector<long long> counts, displs;
+    if (rank == root_rank) {
+        counts.resize(world_size);
+        displs.resize(world_size);
+    }
+    MPI_Gather(&local_count, 1, MPI_LONG_LONG, counts.data(), 1, MPI_LONG_LONG, root_rank, comm);
+    if (rank == root_rank) {
+        for (int i = 0; i < world_size; ++i)
+            displs[i] = (i == 0) ? 0 : displs[i - 1] + counts[i - 1];
+    }
+    occurrences->resize(rank == root_rank ? total_count : 0);
+    largeGatherv(local_indices.data(), local_count, occurrences->data(), counts, displs, MPI_LONG_LONG, root_rank, comm);
+    return total_count;
+}
@@ -11,11 +11,16 @@
 
 #include "../include/algorithms/quick_search.h"
 #include "../include/algorithms/prime_finding.h"
+#include "../include/algorithms/prime_counting.h"
 #include "../include/algorithms/bitonic_sort.h"
 #include "../include/algorithms/radix_sort.h"
 #include "../include/algorithms/sample_sort.h"
 #include "../include/utils/data_utils.h"
 #include "../include/utils/performance.h"
+#include "../include/utils/scan_kernels.h"
+#include "../include/utils/dataset_cache.h"
+#include "../include/utils/benchmark.h"
+#include "../include/utils/phase_profile.h"
 
 using namespace std;
 
@@ -27,16 +32,54 @@ int main(int argc, char* argv[]) {
     MPI_Comm_size(MPI_COMM_WORLD, &world_size);
 
     const int root_rank = 0;
+
+    // --phases prints the per-phase profile after every run; --trace PATH also writes the phases as a Chrome trace.
+    string benchmark_filename;
+    string csv_filename = "output/benchmark.csv";
+    string json_filename = "output/benchmark.json";
+    string trace_filename;
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "--phases") enablePhaseProfile(true);
+        if (i + 1 >= argc) continue;
+        if (arg == "--benchmark") benchmark_filename = argv[++i];
+        else if (arg == "--csv") csv_filename = argv[++i];
+        else if (arg == "--json") json_filename = argv[++i];
+        else if (arg == "--trace") {
+            trace_filename = argv[++i];
+            enablePhaseProfile(true);
+        }
+    }
+
+    // Batch mode: mpirun -np P ./parallel_computation.o --benchmark JOBS [--csv PATH] [--json PATH] [--phases]
+    if (!benchmark_filename.empty()) {
+        int status = runBenchmarks(benchmark_filename, csv_filename, json_filename, root_rank, rank, world_size, MPI_COMM_WORLD);
+        MPI_Finalize();
+        return status;
+    }
+    const long long prime_count_check_limit = 100000000;
     char try_again = 'Y';
 
     do {
         int choice = 0;
         string input_filename;
-        vector<int> global_data_vec;
-        vector<int> local_data_vec;
-        int global_vec_size = 0;
+        static const vector<int> no_data;
+        const vector<int>* dataset = &no_data;
+        bool dataset_cached = false;
+        int cache_command = 1;
+        long long global_vec_size = 0;
         int search_target = 0;
+        int search_mode = 1;
+        string targets_filename;
+        vector<int> search_targets;
         long long prime_lower = 0, prime_upper = 0;
+        int prime_engine_choice = 1;
+        int prime_result_choice = 1;
+        int prime_schedule_choice = 1;
+        long long prime_chunk_size = 0;
+        int sort_output_choice = 1;
+        int sample_oversampling = 0;
+        unsigned long long input_checksum = 0;
 
         if (rank == root_rank) {
             cout << "\n================================================" << endl;
@@ -49,16 +92,36 @@ int main(int argc, char* argv[]) {
             cout << "3 - Bitonic Sort" << endl;
             cout << "4 - Radix Sort" << endl;
             cout << "5 - Sample Sort" << endl;
+            cout << "6 - Prime Counting" << endl;
+            cout << "7 - Dataset Cache" << endl;
             cout << "Enter the number of the algorithm to run: ";
             cin >> choice;
 
-            if (choice == 1 || choice == 3 || choice == 4 || choice == 5) {
+            if (choice == 7) {
+                cout << "Select cache command (1 - Report, 2 - Evict dataset, 3 - Evict all, 4 - Reload dataset): ";
+                cin >> cache_command;
+            }
+            if (choice == 1 || choice == 3 || choice == 4 || choice == 5 || (choice == 7 && (cache_command == 2 || cache_command == 4))) {
                 cout << "Please enter the path to the input file: ";
                 cin >> input_filename;
             }
             if (choice == 1) {
-                cout << "Enter Search Target: ";
-                cin >> search_target;
+                cout << "Select search mode (1 - First occurrence, 2 - Batch of targets from file, 3 - Count occurrences, 4 - All occurrences): ";
+                cin >> search_mode;
+                if (search_mode == 2) {
+                    cout << "Please enter the path to the targets file: ";
+                    cin >> targets_filename;
+                } else {
+                    cout << "Enter Search Target: ";
+                    cin >> search_target;
+                }
+            } else if (choice == 3 || choice == 4 || choice == 5) {
+                cout << "Select output mode (1 - Gather to root text file, 2 - Distributed text file, 3 - Distributed binary file): ";
+                cin >> sort_output_choice;
+                if (choice == 5) {
+                    cout << "Enter oversampling factor (0 for automatic): ";
+                    cin >> sample_oversampling;
+                }
             } else if (choice == 2) {
                 cout << "Enter the lower bound for prime number finding: ";
                 cin >> prime_lower;
@@ -68,10 +131,25 @@ int main(int argc, char* argv[]) {
                     cout << "Error: Upper bound cannot be less than lower bound." << endl;
                     choice = -1;
                 }
-            }
-            else if (choice == 3 && !isPowerOfTwo(world_size)) {
-                cout << "Error: Number of processes is not a power of 2." << endl;
-                choice = -1;
+                cout << "Select prime engine (1 - Automatic, 2 - Segmented Sieve, 3 - Trial Division, 4 - Miller-Rabin): ";
+                cin >> prime_engine_choice;
+                cout << "Select result mode (1 - Text file, 2 - Count only, 3 - Bitset file, 4 - Delta-encoded binary file): ";
+                cin >> prime_result_choice;
+                cout << "Select scheduling (1 - Static blocks, 2 - Dynamic chunks): ";
+                cin >> prime_schedule_choice;
+                if (prime_schedule_choice == 2) {
+                    cout << "Enter chunk size (0 for automatic): ";
+                    cin >> prime_chunk_size;
+                }
+            } else if (choice == 6) {
+                cout << "Enter the lower bound for prime counting: ";
+                cin >> prime_lower;
+                cout << "Enter the upper bound for prime counting: ";
+                cin >> prime_upper;
+                if (prime_upper < prime_lower) {
+                    cout << "Error: Upper bound cannot be less than lower bound." << endl;
+                    choice = -1;
+                }
             }
         }
 
@@ -82,7 +160,11 @@ int main(int argc, char* argv[]) {
             return 1;
         }
 
-        if (choice == 1 || choice == 3 || choice == 4 || choice == 5) {
+        if (choice == 7) {
+            MPI_Bcast(&cache_command, 1, MPI_INT, root_rank, MPI_COMM_WORLD);
+        }
+
+        if (choice == 1 || choice == 3 || choice == 4 || choice == 5 || (choice == 7 && (cache_command == 2 || cache_command == 4))) {
             
             int filename_len = 0;
             
@@ -98,12 +180,14 @@ int main(int argc, char* argv[]) {
 
 
             MPI_Bcast(&input_filename[0], filename_len, MPI_CHAR, root_rank, MPI_COMM_WORLD);
+        }
 
-            if (rank == root_rank) {
-                cout << "Reading data from file..." << endl;
-            }
+        if (choice == 1 || choice == 3 || choice == 4 || choice == 5) {
+            dataset = &acquireDataset(input_filename, root_rank, rank, world_size, MPI_COMM_WORLD, global_vec_size, dataset_cached);
 
-            global_data_vec = readFileData(input_filename, root_rank, rank, MPI_COMM_WORLD, global_vec_size);
+            if (rank == root_rank && global_vec_size > 0) {
+                cout << (dataset_cached ? "Using resident dataset from cache" : "Read data from file") << endl;
+            }
 
             if (global_vec_size == 0 && choice != 2) { 
                  if (rank == root_rank) {
@@ -114,21 +198,43 @@ int main(int argc, char* argv[]) {
             }
         }
         
+        const vector<int>& local_data_vec = *dataset;
+
         if (choice == 1) {
+            MPI_Bcast(&search_mode, 1, MPI_INT, root_rank, MPI_COMM_WORLD);
             MPI_Bcast(&search_target, 1, MPI_INT, root_rank, MPI_COMM_WORLD);
+            if (search_mode == 2) {
+                long long target_count = 0;
+                search_targets = readFileData(targets_filename, root_rank, rank, MPI_COMM_WORLD, target_count);
+                search_targets.resize(target_count);
+                MPI_Bcast(search_targets.data(), target_count, MPI_INT, root_rank, MPI_COMM_WORLD);
+            }
+        }
+
+        if (choice == 3 || choice == 4 || choice == 5) {
+            MPI_Bcast(&sort_output_choice, 1, MPI_INT, root_rank, MPI_COMM_WORLD);
+            MPI_Bcast(&sample_oversampling, 1, MPI_INT, root_rank, MPI_COMM_WORLD);
+            if (sort_output_choice != 1 && global_vec_size > 0) {
+                input_checksum = distributedChecksum(local_data_vec, MPI_COMM_WORLD);
+            }
         }
 
         if (choice == 2) {
             MPI_Bcast(&prime_lower, 1, MPI_LONG_LONG, root_rank, MPI_COMM_WORLD);
             MPI_Bcast(&prime_upper, 1, MPI_LONG_LONG, root_rank, MPI_COMM_WORLD);
+            MPI_Bcast(&prime_engine_choice, 1, MPI_INT, root_rank, MPI_COMM_WORLD);
+            MPI_Bcast(&prime_result_choice, 1, MPI_INT, root_rank, MPI_COMM_WORLD);
+            MPI_Bcast(&prime_schedule_choice, 1, MPI_INT, root_rank, MPI_COMM_WORLD);
+            MPI_Bcast(&prime_chunk_size, 1, MPI_LONG_LONG, root_rank, MPI_COMM_WORLD);
         }
 
-        if ((choice == 1 || choice == 3 || choice == 4 || choice == 5) && global_vec_size > 0) {
-            if (rank == root_rank) cout << "Distributing data across processes..." << endl;
-            distributeDataScatterv(global_data_vec, local_data_vec, root_rank, rank, world_size, MPI_COMM_WORLD);
+        if (choice == 6) {
+            MPI_Bcast(&prime_lower, 1, MPI_LONG_LONG, root_rank, MPI_COMM_WORLD);
+            MPI_Bcast(&prime_upper, 1, MPI_LONG_LONG, root_rank, MPI_COMM_WORLD);
         }
 
         MPI_Barrier(MPI_COMM_WORLD);
+        resetPhaseProfile();
         double start_time = MPI_Wtime();
         double end_time;
         vector<int> result_vec;
@@ -142,16 +248,73 @@ int main(int argc, char* argv[]) {
                 }
 
                  if (global_vec_size == 0) {
+                    end_time = MPI_Wtime();
                     if(rank == root_rank) 
                         cout << "Result: No data to search in." << endl;
                     break;
                 }
 
+                if (search_mode == 2) {
+                    if (search_targets.empty()) {
+                        end_time = MPI_Wtime();
+                        if (rank == root_rank)
+                            cout << "Result: No targets to search for." << endl;
+                        break;
+                    }
+                    if (rank == root_rank) {
+                        cout << "Each process is indexing its assigned range..." << endl;
+                    }
+                    SearchIndex search_index = buildSearchIndex(local_data_vec, rank, MPI_COMM_WORLD);
+                    double index_time = MPI_Wtime();
+                    vector<long long> first_indices = parallelBatchSearch(search_index, search_targets, root_rank, rank, MPI_COMM_WORLD);
+                    end_time = MPI_Wtime();
+
+                    if (rank == root_rank) {
+                        long long found = 0;
+                        ofstream outfile("output/search_results.txt");
+                        for (size_t t = 0; t < search_targets.size(); ++t) {
+                            if (first_indices[t] >= 0) found++;
+                            outfile << search_targets[t] << " " << first_indices[t] << "\n";
+                        }
+                        outfile.close();
+                        double query_time = end_time - index_time;
+                        cout << "Result: " << found << " of " << search_targets.size() << " targets found" << endl;
+                        cout << "Index built in " << fixed << setprecision(6) << index_time - start_time << " seconds; "
+                             << search_targets.size() << " queries answered in " << query_time << " seconds ("
+                             << setprecision(0) << (query_time > 0 ? search_targets.size() / query_time : 0.0)
+                             << " queries/s)" << endl;
+                        cout.unsetf(ios::floatfield);
+                        cout << setprecision(6);
+                        cout << "First indices stored in output/search_results.txt" << endl;
+                    }
+                    break;
+                }
+
                 if (rank == root_rank) {
                     cout << "Each process is searching its assigned range..." << endl;
+                    cout << "Scan kernel: " << scanKernelName() << endl;
                 }
 
-                pair<bool, int> search_res = parallelQuickSearch(local_data_vec, search_target, global_vec_size, rank, world_size, MPI_COMM_WORLD);
+                if (search_mode == 3 || search_mode == 4) {
+                    vector<long long> occurrences;
+                    long long occurrence_count = parallelFindAll(local_data_vec, search_target, root_rank, rank, world_size,
+                                                                 MPI_COMM_WORLD, (search_mode == 4) ? &occurrences : nullptr);
+                    end_time = MPI_Wtime();
+                    if (rank == root_rank) {
+                        cout << "Result: Value " << search_target << " occurs " << occurrence_count << " time(s)" << endl;
+                        if (search_mode == 4) {
+                            ofstream outfile("output/search_occurrences.txt");
+                            for (long long idx : occurrences) outfile << idx << "\n";
+                            outfile.close();
+                            cout << "Global indices stored in output/search_occurrences.txt" << endl;
+                        }
+                    }
+                    break;
+                }
+
+                long long elements_scanned = 0;
+                pair<bool, long long> search_res = parallelQuickSearch(local_data_vec, search_target, global_vec_size, rank, world_size,
+                                                                       MPI_COMM_WORLD, &elements_scanned);
                 end_time = MPI_Wtime();
 
 
@@ -161,6 +324,7 @@ int main(int argc, char* argv[]) {
                     } else {
                         cout << "Result: Value " << search_target << " not found." << endl;
                     }
+                    cout << "Elements scanned: " << elements_scanned << " of " << global_vec_size << endl;
                 }
                 break;
             }
@@ -169,7 +333,37 @@ int main(int argc, char* argv[]) {
                     cout << "\nPrime Number Finding Selected" << endl;
                 }
 
-                result_primes_vec = parallelPrimeFinding(prime_lower, prime_upper, rank, world_size, MPI_COMM_WORLD);
+                PrimeFindingOptions prime_options;
+                if (prime_engine_choice == 2) prime_options.engine = PRIME_ENGINE_SIEVE;
+                if (prime_engine_choice == 3) prime_options.engine = PRIME_ENGINE_TRIAL_DIVISION;
+                if (prime_engine_choice == 4) prime_options.engine = PRIME_ENGINE_MILLER_RABIN;
+                prime_options.schedule = (prime_schedule_choice == 2) ? PRIME_SCHEDULE_DYNAMIC : PRIME_SCHEDULE_STATIC;
+                prime_options.chunk_size = prime_chunk_size;
+                prime_options.report_busy_time = true;
+                if (prime_result_choice >= 2 && prime_result_choice <= 4) {
+                    PrimeResultMode prime_mode = PRIME_RESULT_COUNT;
+                    string prime_filename;
+                    if (prime_result_choice == 3) {
+                        prime_mode = PRIME_RESULT_BITSET; prime_filename = "output/primes_bitset.bin";
+                    }
+                    if (prime_result_choice == 4) {
+                        prime_mode = PRIME_RESULT_DELTA; prime_filename = "output/primes_delta.bin";
+                    }
+
+                    long long prime_count = parallelPrimeFindingCompact(prime_lower, prime_upper, rank, world_size, MPI_COMM_WORLD,
+                                                                        prime_mode, prime_filename, prime_options);
+                    end_time = MPI_Wtime();
+                    if (rank == root_rank) {
+                        cout << "Result: Found " << prime_count << " prime numbers between "
+                                  << prime_lower << " and " << prime_upper << "." << endl;
+                        if (!prime_filename.empty()) {
+                            cout << "All prime numbers stored in " << prime_filename << endl;
+                        }
+                    }
+                    break;
+                }
+
+                result_primes_vec = parallelPrimeFinding(prime_lower, prime_upper, rank, world_size, MPI_COMM_WORLD, prime_options);
                 end_time = MPI_Wtime();
                 if (rank == root_rank) {
                     cout << "Result: Found " << result_primes_vec.size() << " prime numbers between "
@@ -188,6 +382,7 @@ int main(int argc, char* argv[]) {
             case 4:   
             case 5: { 
                  if (global_vec_size == 0) {
+                    end_time = MPI_Wtime();
                     if(rank == root_rank) cout << "Result: No data to sort." << endl;
                     break;
                 }
@@ -212,20 +407,46 @@ int main(int argc, char* argv[]) {
                      cout << "Performing digit-wise counting and merging..." << endl;
                 }
 
+                bool gather_result = (sort_output_choice != 2 && sort_output_choice != 3);
                 if (choice == 3) {
-                    result_vec = parallelBitonicSort(local_data_vec, global_vec_size, rank, world_size, MPI_COMM_WORLD);
+                    result_vec = parallelBitonicSort(local_data_vec, global_vec_size, rank, world_size, MPI_COMM_WORLD, gather_result);
                 }
 
                 else if (choice == 4) {
-                    result_vec = parallelRadixSort(local_data_vec, global_vec_size, rank, world_size, MPI_COMM_WORLD);
+                    result_vec = parallelRadixSort(local_data_vec, global_vec_size, rank, world_size, MPI_COMM_WORLD, gather_result);
                 }
 
                 else if (choice == 5){
-                    result_vec = parallelSampleSort(local_data_vec, global_vec_size, rank, world_size, MPI_COMM_WORLD);
+                    result_vec = parallelSampleSort(local_data_vec, global_vec_size, rank, world_size, MPI_COMM_WORLD, gather_result,
+                                                    sample_oversampling);
                 }
 
                 end_time = MPI_Wtime();
 
+                if (!gather_result) {
+                    bool binary_output = (sort_output_choice == 3);
+                    if (binary_output) {
+                        out_filename.replace(out_filename.size() - 4, 4, ".bin");
+                    }
+                    bool written = writeDistributedData(out_filename, result_vec, binary_output,
+                                                        root_rank, rank, MPI_COMM_WORLD);
+                    bool sorted = isDistributedSorted(result_vec, rank, world_size, MPI_COMM_WORLD);
+                    unsigned long long output_checksum = distributedChecksum(result_vec, MPI_COMM_WORLD);
+                    long long local_count = result_vec.size();
+                    long long output_count = 0;
+                    MPI_Reduce(&local_count, &output_count, 1, MPI_LONG_LONG, MPI_SUM, root_rank, MPI_COMM_WORLD);
+                    if (rank == root_rank) {
+                        if (written) {
+                            cout << "Sorted array stored in " << out_filename << endl;
+                        }
+                        bool complete = (output_count == global_vec_size && output_checksum == input_checksum);
+                        cout << "Verification: " << (sorted ? "globally sorted" : "NOT SORTED") << ", "
+                             << (complete ? "checksum matches input" : "CHECKSUM MISMATCH")
+                             << " (" << output_count << " elements)" << endl;
+                    }
+                    break;
+                }
+
                 if (rank == root_rank) {
                     if (!result_vec.empty()) {
                         ofstream outfile(out_filename);
@@ -242,6 +463,53 @@ int main(int argc, char* argv[]) {
                 }
                 break;
             }
+            case 6: {
+                if (rank == root_rank) {
+                    cout << "\nPrime Counting Selected" << endl;
+                }
+
+                long long prime_count = parallelPrimeCount(prime_lower, prime_upper, rank, world_size, MPI_COMM_WORLD);
+                end_time = MPI_Wtime();
+                if (rank == root_rank) {
+                    cout << "Result: There are " << prime_count << " prime numbers between "
+                              << prime_lower << " and " << prime_upper << "." << endl;
+                }
+
+                if (prime_upper <= prime_count_check_limit) {
+                    PrimeFindingOptions check_options;
+                    check_options.engine = PRIME_ENGINE_SIEVE;
+                    long long sieve_count = parallelPrimeFindingCompact(prime_lower, prime_upper, rank, world_size, MPI_COMM_WORLD,
+                                                                        PRIME_RESULT_COUNT, "", check_options);
+                    if (rank == root_rank) {
+                        cout << "Cross-check against segmented sieve: " << (sieve_count == prime_count ? "OK" : "MISMATCH")
+                             << " (" << sieve_count << " primes)" << endl;
+                    }
+                }
+                break;
+            }
+            case 7: {
+                if (cache_command == 2 || cache_command == 4) {
+                    bool evicted = evictDataset(input_filename);
+                    if (rank == root_rank && cache_command == 2) {
+                        cout << (evicted ? "Evicted " : "Not resident: ") << input_filename << endl;
+                    }
+                }
+                if (cache_command == 3) {
+                    evictAllDatasets();
+                    if (rank == root_rank) cout << "Evicted all datasets" << endl;
+                }
+                if (cache_command == 4) {
+                    long long reloaded_size = 0;
+                    bool cached = false;
+                    acquireDataset(input_filename, root_rank, rank, world_size, MPI_COMM_WORLD, reloaded_size, cached);
+                    if (rank == root_rank) {
+                        cout << "Reloaded " << input_filename << " (" << reloaded_size << " elements)" << endl;
+                    }
+                }
+                end_time = MPI_Wtime();
+                reportDatasetCache(root_rank, rank, world_size, MPI_COMM_WORLD);
+                break;
+            }
             default:
                 if (rank == root_rank) cout << "Invalid choice." << endl;
                 end_time = start_time; 
@@ -252,9 +520,9 @@ int main(int argc, char* argv[]) {
         double elapsed_time = end_time - start_time;
 
 
-        if (choice >= 1 && choice <= 5) {
+        if (choice >= 1 && choice <= 6) {
             string name = "";
-            int data_items = 0;
+            long long data_items = 0;
             if(choice == 1) { 
                 name = "Quick Search"; data_items = global_vec_size; 
             }
@@ -270,10 +538,21 @@ int main(int argc, char* argv[]) {
             if(choice == 5) {
                 name = "Sample Sort"; data_items = global_vec_size;
             }
+            if(choice == 6) {
+                name = "Prime Counting"; data_items = prime_upper - prime_lower + 1;
+            }
 
-            if (!( (choice == 1 || choice >=3) && global_vec_size == 0) ) {
+            if (!( (choice == 1 || (choice >= 3 && choice <= 5)) && global_vec_size == 0) ) {
                  analyzeAndPrintPerformance(name, data_items, world_size, elapsed_time, rank, MPI_COMM_WORLD);
             }
+
+            if (phaseProfileEnabled()) {
+                reportPhaseProfile(root_rank, rank, world_size, MPI_COMM_WORLD);
+            }
+            if (!trace_filename.empty() && writePhaseTrace(trace_filename, root_rank, rank, world_size, MPI_COMM_WORLD)
+                && rank == root_rank) {
+                cout << "Phase trace stored in " << trace_filename << endl;
+            }
         }
 
 
@@ -0,0 +1,580 @@
+// MPI profiling layer built on the PMPI interface. Linking libmpi_profiler.a ahead of the MPI library
+// (./compile.sh --mpi-profile) replaces the MPI functions below with wrappers that time the matching PMPI call,
+// so no algorithm code changes. Every rank records per function and per communicator the call count, the bytes
+// passed through its own buffers (sent plus received) and the inclusive time spent inside the call, which for
+// blocking calls is mostly time spent waiting for other ranks. MPI_Finalize gathers the records to rank 0 and
+// prints the summary, or writes it to the file named by the MPI_PROFILE_FILE environment variable.
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <cstdlib>
+#include <algorithm>
+#include <mpi.h>
+
+using namespace std;
+
+enum ProfiledCall {
+    CALL_BARRIER, CALL_BCAST, CALL_REDUCE, CALL_ALLREDUCE, CALL_EXSCAN,
+    CALL_GATHER, CALL_GATHERV, CALL_SCATTERV, CALL_ALLGATHER, CALL_ALLGATHERV, CALL_ALLTOALL, CALL_ALLTOALLV,
+    CALL_SEND, CALL_RECV, CALL_ISEND, CALL_IRECV, CALL_SEND_INIT, CALL_RECV_INIT,
+    CALL_START, CALL_STARTALL, CALL_WAIT, CALL_WAITALL,
+    CALL_FETCH_AND_OP, CALL_WIN_FLUSH, CALL_FILE_READ_AT_ALL, CALL_FILE_WRITE_AT_ALL,
+    CALL_COUNT
+};
+
+static const char* CALL_NAMES[CALL_COUNT] = {
+    "MPI_Barrier", "MPI_Bcast", "MPI_Reduce", "MPI_Allreduce", "MPI_Exscan",
+    "MPI_Gather", "MPI_Gatherv", "MPI_Scatterv", "MPI_Allgather", "MPI_Allgatherv", "MPI_Alltoall", "MPI_Alltoallv",
+    "MPI_Send", "MPI_Recv", "MPI_Isend", "MPI_Irecv", "MPI_Send_init", "MPI_Recv_init",
+    "MPI_Start", "MPI_Startall", "MPI_Wait", "MPI_Waitall",
+    "MPI_Fetch_and_op", "MPI_Win_flush", "MPI_File_read_at_all", "MPI_File_write_at_all"
+};
+
+struct CallStats {
+    long long calls;
+    long long bytes;
+    double seconds;
+};
+
+// Statistics are kept per target: a communicator, or a pseudo-target for calls that do not take one.
+struct TargetStats {
+    string name;
+    CallStats calls[CALL_COUNT];
+};
+
+// A request made by a wrapped call. Persistent requests keep their handle across starts and are forgotten when
+// freed; the others are forgotten when a wait completes them.
+struct RequestInfo {
+    int target;
+    long long bytes;
+    bool persistent;
+};
+
+static double init_time = 0.0;
+static vector<TargetStats> targets;
+static map<string, int> target_ids;
+static map<MPI_Comm, int> comm_targets;
+static map<MPI_Request, RequestInfo> request_infos;
+
+static int namedTarget(const string& name) {
+    auto it = target_ids.find(name);
+    if (it != target_ids.end())
+        return it->second;
+    TargetStats stats;
+    stats.name = name;
+    for (CallStats& call : stats.calls)
+        call = {0, 0, 0.0};
+    targets.push_back(stats);
+    target_ids[name] = targets.size() - 1;
+    return targets.size() - 1;
+}
+
+// Communicators are named after MPI_Comm_get_name; unnamed ones get a number in order of first use and their size.
+static int commTarget(MPI_Comm comm) {
+    auto it = comm_targets.find(comm);
+    if (it != comm_targets.end())
+        return it->second;
+    char name[MPI_MAX_OBJECT_NAME];
+    int length = 0;
+    PMPI_Comm_get_name(comm, name, &length);
+    string target_name(name, length);
+    if (target_name.empty()) {
+        int size = 0;
+        PMPI_Comm_size(comm, &size);
+        target_name = "comm " + to_string(comm_targets.size()) + " (size " + to_string(size) + ")";
+    }
+    int id = namedTarget(target_name);
+    comm_targets[comm] = id;
+    return id;
+}
+
+static void record(int target, ProfiledCall call, long long bytes, double start) {
+    CallStats& stats = targets[target].calls[call];
+    stats.calls++;
+    stats.bytes += bytes;
+    stats.seconds += PMPI_Wtime() - start;
+}
+
+static long long typeBytes(MPI_Datatype type, long long count) {
+    int size = 0;
+    PMPI_Type_size(type, &size);
+    return count * size;
+}
+
+template<typename Count>
+static long long sumCounts(const Count counts[], MPI_Comm comm) {
+    int size = 0;
+    PMPI_Comm_size(comm, &size);
+    long long total = 0;
+    for (int i = 0; i < size; ++i)
+        total += counts[i];
+    return total;
+}
+
+static bool isRoot(int root, MPI_Comm comm) {
+    int rank = 0;
+    PMPI_Comm_rank(comm, &rank);
+    return rank == root;
+}
+
+static int commSize(MPI_Comm comm) {
+    int size = 0;
+    PMPI_Comm_size(comm, &size);
+    return size;
+}
+
+// Calls over several requests are charged to the communicator of the first request the profiler knows, with the
+// bytes of all of them (the project never mixes communicators in one call); unknown requests go to "(requests)".
+static int requestsTarget(int count, const MPI_Request requests[], bool started, long long& bytes) {
+    int target = -1;
+    bytes = 0;
+    for (int i = 0; i < count; ++i) {
+        auto it = request_infos.find(requests[i]);
+        if (it == request_infos.end())
+            continue;
+        if (target < 0)
+            target = it->second.target;
+        if (started)
+            bytes += it->second.bytes;
+    }
+    return (target < 0) ? namedTarget("(requests)") : target;
+}
+
+// Completed nonblocking requests are MPI_REQUEST_NULL after the wait, so they are found by their old handles.
+static void forgetCompleted(int count, const MPI_Request old_requests[]) {
+    for (int i = 0; i < count; ++i) {
+        auto it = request_infos.find(old_requests[i]);
+        if (it != request_infos.end() && !it->second.persistent)
+            request_infos.erase(it);
+    }
+}
+
+int MPI_Init(int* argc, char*** argv) {
+    int result = PMPI_Init(argc, argv);
+    init_time = PMPI_Wtime();
+    return result;
+}
+
+int MPI_Init_thread(int* argc, char*** argv, int required, int* provided) {
+    int result = PMPI_Init_thread(argc, argv, required, provided);
+    init_time = PMPI_Wtime();
+    return result;
+}
+
+int MPI_Barrier(MPI_Comm comm) {
+    double start = PMPI_Wtime();
+    int result = PMPI_Barrier(comm);
+    record(commTarget(comm), CALL_BARRIER, 0, start);
+    return result;
+}
+
+int MPI_Bcast(void* buffer, int count, MPI_Datatype datatype, int root, MPI_Comm comm) {
+    double start = PMPI_Wtime();
+    int result = PMPI_Bcast(buffer, count, datatype, root, comm);
+    record(commTarget(comm), CALL_BCAST, typeBytes(datatype, count), start);
+    return result;
+}
+
+int MPI_Reduce(const void* sendbuf, void* recvbuf, int count, MPI_Datatype datatype, MPI_Op op, int root, MPI_Comm comm) {
+    double start = PMPI_Wtime();
+    int result = PMPI_Reduce(sendbuf, recvbuf, count, datatype, op, root, comm);
+    record(commTarget(comm), CALL_REDUCE, typeBytes(datatype, isRoot(root, comm) ? 2LL * count : count), start);
+    return result;
+}
+
+int MPI_Allreduce(const void* sendbuf, void* recvbuf, int count, MPI_Datatype datatype, MPI_Op op, MPI_Comm comm) {
+    double start = PMPI_Wtime();
+    int result = PMPI_Allreduce(sendbuf, recvbuf, count, datatype, op, comm);
+    record(commTarget(comm), CALL_ALLREDUCE, 2 * typeBytes(datatype, count), start);
+    return result;
+}
+
+int MPI_Exscan(const void* sendbuf, void* recvbuf, int count, MPI_Datatype datatype, MPI_Op op, MPI_Comm comm) {
+    double start = PMPI_Wtime();
+    int result = PMPI_Exscan(sendbuf, recvbuf, count, datatype, op, comm);
+    record(commTarget(comm), CALL_EXSCAN, 2 * typeBytes(datatype, count), start);
+    return result;
+}
+
+int MPI_Gather(const void* sendbuf, int sendcount, MPI_Datatype sendtype,
+               void* recvbuf, int recvcount, MPI_Datatype recvtype, int root, MPI_Comm comm) {
+    double start = PMPI_Wtime();
+    int result = PMPI_Gather(sendbuf, sendcount, sendtype, recvbuf, recvcount, recvtype, root, comm);
+    long long bytes = (sendbuf == MPI_IN_PLACE) ? 0 : typeBytes(sendtype, sendcount);
+    if (isRoot(root, comm))
+        bytes += typeBytes(recvtype, (long long)recvcount * commSize(comm));
+    record(commTarget(comm), CALL_GATHER, bytes, start);
+    return result;
+}
+
+int MPI_Gatherv(const void* sendbuf, int sendcount, MPI_Datatype sendtype,
+                void* recvbuf, const int recvcounts[], const int displs[], MPI_Datatype recvtype, int root, MPI_Comm comm) {
+    double start = PMPI_Wtime();
+    int result = PMPI_Gatherv(sendbuf, sendcount, sendtype, recvbuf, recvcounts, displs, recvtype, root, comm);
+    long long bytes = (sendbuf == MPI_IN_PLACE) ? 0 : typeBytes(sendtype, sendcount);
+    if (isRoot(root, comm))
+        bytes += typeBytes(recvtype, sumCounts(recvcounts, comm));
+    record(commTarget(comm), CALL_GATHERV, bytes, start);
+    return result;
+}
+
+int MPI_Scatterv(const void* sendbuf, const int sendcounts[], const int displs[], MPI_Datatype sendtype,
+                 void* recvbuf, int recvcount, MPI_Datatype recvtype, int root, MPI_Comm comm) {
+    double start = PMPI_Wtime();
+    int result = PMPI_Scatterv(sendbuf, sendcounts, displs, sendtype, recvbuf, recvcount, recvtype, root, comm);
+    long long bytes = (recvbuf == MPI_IN_PLACE) ? 0 : typeBytes(recvtype, recvcount);
+    if (isRoot(root, comm))
+        bytes += typeBytes(sendtype, sumCounts(sendcounts, comm));
+    record(commTarget(comm), CALL_SCATTERV, bytes, start);
+    return result;
+}
+
+int MPI_Allgather(const void* sendbuf, int sendcount, MPI_Datatype sendtype,
+                  void* recvbuf, int recvcount, MPI_Datatype recvtype, MPI_Comm comm) {
+    double start = PMPI_Wtime();
+    int result = PMPI_Allgather(sendbuf, sendcount, sendtype, recvbuf, recvcount, recvtype, comm);
+    long long bytes = (sendbuf == MPI_IN_PLACE) ? 0 : typeBytes(sendtype, sendcount);
+    bytes += typeBytes(recvtype, (long long)recvcount * commSize(comm));
+    record(commTarget(comm), CALL_ALLGATHER, bytes, start);
+    return result;
+}
+
+int MPI_Allgatherv(const void* sendbuf, int sendcount, MPI_Datatype sendtype,
+                   void* recvbuf, const int recvcounts[], const int displs[], MPI_Datatype recvtype, MPI_Comm comm) {
+    double start = PMPI_Wtime();
+    int result = PMPI_Allgatherv(sendbuf, sendcount, sendtype, recvbuf, recvcounts, displs, recvtype, comm);
+    long long bytes = (sendbuf == MPI_IN_PLACE) ? 0 : typeBytes(sendtype, sendcount);
+    bytes += typeBytes(recvtype, sumCounts(recvcounts, comm));
+    record(commTarget(comm), CALL_ALLGATHERV, bytes, start);
+    return result;
+}
+
+int MPI_Alltoall(const void* sendbuf, int sendcount, MPI_Datatype sendtype,
+                 void* recvbuf, int recvcount, MPI_Datatype recvtype, MPI_Comm comm) {
+    double start = PMPI_Wtime();
+    int result = PMPI_Alltoall(sendbuf, sendcount, sendtype, recvbuf, recvcount, recvtype, comm);
+    int size = commSize(comm);
+    long long bytes = typeBytes(recvtype, (long long)recvcount * size);
+    if (sendbuf != MPI_IN_PLACE)
+        bytes += typeBytes(sendtype, (long long)sendcount * size);
+    record(commTarget(comm), CALL_ALLTOALL, bytes, start);
+    return result;
+}
+
+int MPI_Alltoallv(const void* sendbuf, const int sendcounts[], const int sdispls[], MPI_Datatype sendtype,
+                  void* recvbuf, const int recvcounts[], const int rdispls[], MPI_Datatype recvtype, MPI_Comm comm) {
+    double start = PMPI_Wtime();
+    int result = PMPI_Alltoallv(sendbuf, sendcounts, sdispls, sendtype, recvbuf, recvcounts, rdispls, recvtype, comm);
+    long long bytes = typeBytes(recvtype, sumCounts(recvcounts, comm));
+    if (sendbuf != MPI_IN_PLACE)
+        bytes += typeBytes(sendtype, sumCounts(sendcounts, comm));
+    record(commTarget(comm), CALL_ALLTOALLV, bytes, start);
+    return result;
+}
+
+#if MPI_VERSION >= 4
+// Large-count variants used by utils/mpi_large_count.cpp; they are reported under the same function as the int ones.
+int MPI_Gatherv_c(const void* sendbuf, MPI_Count sendcount, MPI_Datatype sendtype, void* recvbuf,
+                  const MPI_Count recvcounts[], const MPI_Aint displs[], MPI_Datatype recvtype, int root, MPI_Comm comm) {
+    double start = PMPI_Wtime();
+    int result = PMPI_Gatherv_c(sendbuf, sendcount, sendtype, recvbuf, recvcounts, displs, recvtype, root, comm);
+    long long bytes = (sendbuf == MPI_IN_PLACE) ? 0 : typeBytes(sendtype, sendcount);
+    if (isRoot(root, comm))
+        bytes += typeBytes(recvtype, sumCounts(recvcounts, comm));
+    record(commTarget(comm), CALL_GATHERV, bytes, start);
+    return result;
+}
+
+int MPI_Scatterv_c(const void* sendbuf, const MPI_Count sendcounts[], const MPI_Aint displs[], MPI_Datatype sendtype,
+                   void* recvbuf, MPI_Count recvcount, MPI_Datatype recvtype, int root, MPI_Comm comm) {
+    double start = PMPI_Wtime();
+    int result = PMPI_Scatterv_c(sendbuf, sendcounts, displs, sendtype, recvbuf, recvcount, recvtype, root, comm);
+    long long bytes = (recvbuf == MPI_IN_PLACE) ? 0 : typeBytes(recvtype, recvcount);
+    if (isRoot(root, comm))
+        bytes += typeBytes(sendtype, sumCounts(sendcounts, comm));
+    record(commTarget(comm), CALL_SCATTERV, bytes, start);
+    return result;
+}
+
+int MPI_Alltoallv_c(const void* sendbuf, const MPI_Count sendcounts[], const MPI_Aint sdispls[], MPI_Datatype sendtype,
+                    void* recvbuf, const MPI_Count recvcounts[], const MPI_Aint rdispls[], MPI_Datatype recvtype,
+                    MPI_Comm comm) {
+    double start = PMPI_Wtime();
+    int result = PMPI_Alltoallv_c(sendbuf, sendcounts, sdispls, sendtype, recvbuf, recvcounts, rdispls, recvtype, comm);
+    long long bytes = typeBytes(recvtype, sumCounts(recvcounts, comm));
+    if (sendbuf != MPI_IN_PLACE)
+        bytes += typeBytes(sendtype, sumCounts(sendcounts, comm));
+    record(commTarget(comm), CALL_ALLTOALLV, bytes, start);
+    return result;
+}
+#endif
+
+int MPI_Send(const void* buf, int count, MPI_Datatype datatype, int dest, int tag, MPI_Comm comm) {
+    double start = PMPI_Wtime();
+    int result = PMPI_Send(buf, count, datatype, dest, tag, comm);
+    record(commTarget(comm), CALL_SEND, typeBytes(datatype, count), start);
+    return result;
+}
+
+int MPI_Recv(void* buf, int count, MPI_Datatype datatype, int source, int tag, MPI_Comm comm, MPI_Status* status) {
+    double start = PMPI_Wtime();
+    int result = PMPI_Recv(buf, count, datatype, source, tag, comm, status);
+    record(commTarget(comm), CALL_RECV, typeBytes(datatype, count), start);
+    return result;
+}
+
+// Nonblocking operations are charged their posted size, persistent ones their size on every start; the waiting
+// shows up in MPI_Wait(all), charged to the communicator of the requests it completes.
+int MPI_Isend(const void* buf, int count, MPI_Datatype datatype, int dest, int tag, MPI_Comm comm, MPI_Request* request) {
+    double start = PMPI_Wtime();
+    int result = PMPI_Isend(buf, count, datatype, dest, tag, comm, request);
+    int target = commTarget(comm);
+    request_infos[*request] = {target, typeBytes(datatype, count), false};
+    record(target, CALL_ISEND, typeBytes(datatype, count), start);
+    return result;
+}
+
+int MPI_Irecv(void* buf, int count, MPI_Datatype datatype, int source, int tag, MPI_Comm comm, MPI_Request* request) {
+    double start = PMPI_Wtime();
+    int result = PMPI_Irecv(buf, count, datatype, source, tag, comm, request);
+    int target = commTarget(comm);
+    request_infos[*request] = {target, typeBytes(datatype, count), false};
+    record(target, CALL_IRECV, typeBytes(datatype, count), start);
+    return result;
+}
+
+int MPI_Send_init(const void* buf, int count, MPI_Datatype datatype, int dest, int tag, MPI_Comm comm,
+                  MPI_Request* request) {
+    double start = PMPI_Wtime();
+    int result = PMPI_Send_init(buf, count, datatype, dest, tag, comm, request);
+    int target = commTarget(comm);
+    request_infos[*request] = {target, typeBytes(datatype, count), true};
+    record(target, CALL_SEND_INIT, 0, start);
+    return result;
+}
+
+int MPI_Recv_init(void* buf, int count, MPI_Datatype datatype, int source, int tag, MPI_Comm comm,
+                  MPI_Request* request) {
+    double start = PMPI_Wtime();
+    int result = PMPI_Recv_init(buf, count, datatype, source, tag, comm, request);
+    int target = commTarget(comm);
+    request_infos[*request] = {target, typeBytes(datatype, count), true};
+    record(target, CALL_RECV_INIT, 0, start);
+    return result;
+}
+
+int MPI_Request_free(MPI_Request* request) {
+    request_infos.erase(*request);
+    return PMPI_Request_free(request);
+}
+
+int MPI_Start(MPI_Request* request) {
+    long long bytes = 0;
+    int target = requestsTarget(1, request, true, bytes);
+    double start = PMPI_Wtime();
+    int result = PMPI_Start(request);
+    record(target, CALL_START, bytes, start);
+    return result;
+}
+
+int MPI_Startall(int count, MPI_Request array_of_requests[]) {
+    long long bytes = 0;
+    int target = requestsTarget(count, array_of_requests, true, bytes);
+    double start = PMPI_Wtime();
+    int result = PMPI_Startall(count, array_of_requests);
+    record(target, CALL_STARTALL, bytes, start);
+    return result;
+}
+
+int MPI_Wait(MPI_Request* request, MPI_Status* status) {
+    MPI_Request old_request = *request;
+    long long bytes = 0;
+    int target = requestsTarget(1, &old_request, false, bytes);
+    double start = PMPI_Wtime();
+    int result = PMPI_Wait(request, status);
+    record(target, CALL_WAIT, 0, start);
+    forgetCompleted(1, &old_request);
+    return result;
+}
+
+int MPI_Waitall(int count, MPI_Request array_of_requests[], MPI_Status* array_of_statuses) {
+    vector<MPI_Request> old_requests(array_of_requests, array_of_requests + count);
+    long long bytes = 0;
+    int target = requestsTarget(count, old_requests.data(), false, bytes);
+    double start = PMPI_Wtime();
+    int result = PMPI_Waitall(count, array_of_requests, array_of_statuses);
+    record(target, CALL_WAITALL, 0, start);
+    forgetCompleted(count, old_requests.data());
+    return result;
+}
+
+int MPI_Fetch_and_op(const void* origin_addr, void* result_addr, MPI_Datatype datatype,
+                     int target_rank, MPI_Aint target_disp, MPI_Op op, MPI_Win win) {
+    double start = PMPI_Wtime();
+    int result = PMPI_Fetch_and_op(origin_addr, result_addr, datatype, target_rank, target_disp, op, win);
+    record(namedTarget("(windows)"), CALL_FETCH_AND_OP, typeBytes(datatype, (op == MPI_NO_OP) ? 1 : 2), start);
+    return result;
+}
+
+int MPI_Win_flush(int rank, MPI_Win win) {
+    double start = PMPI_Wtime();
+    int result = PMPI_Win_flush(rank, win);
+    record(namedTarget("(windows)"), CALL_WIN_FLUSH, 0, start);
+    return result;
+}
+
+int MPI_File_read_at_all(MPI_File fh, MPI_Offset offset, void* buf, int count, MPI_Datatype datatype, MPI_Status* status) {
+    double start = PMPI_Wtime();
+    int result = PMPI_File_read_at_all(fh, offset, buf, count, datatype, status);
+    record(namedTarget("(files)"), CALL_FILE_READ_AT_ALL, typeBytes(datatype, count), start);
+    return result;
+}
+
+int MPI_File_write_at_all(MPI_File fh, MPI_Offset offset, const void* buf, int count, MPI_Datatype datatype,
+                          MPI_Status* status) {
+    double start = PMPI_Wtime();
+    int result = PMPI_File_write_at_all(fh, offset, buf, count, datatype, status);
+    record(namedTarget("(files)"), CALL_FILE_WRITE_AT_ALL, typeBytes(datatype, count), start);
+    return result;
+}
+
+// Records of one rank, one line each: target, function, calls, bytes, seconds. The first line is the wall time.
+static string serializeProfile() {
+    ostringstream out;
+    out << setprecision(9) << "wall\t" << PMPI_Wtime() - init_time << "\n";
+    for (const TargetStats& target : targets) {
+        for (int c = 0; c < CALL_COUNT; ++c) {
+            const CallStats& stats = target.calls[c];
+            if (stats.calls > 0)
+                out << target.name << "\t" << c << "\t" << stats.calls << "\t" << stats.bytes << "\t" << stats.seconds << "\n";
+        }
+    }
+    return out.str();
+}
+
+struct RankSummary {
+    double wall;
+    double mpi_seconds;
+    long long calls;
+    long long bytes;
+    CallStats per_call[CALL_COUNT];
+};
+
+static void printProfile(ostream& out, const vector<RankSummary>& ranks, const map<pair<string, int>, CallStats>& per_target) {
+    const double MB = 1024.0 * 1024.0;
+    int size = ranks.size();
+    out << "\n=== MPI Profile (" << size << " processes) ===" << endl;
+    out << fixed;
+
+    out << left << setw(24) << "Function" << right << setw(12) << "Calls" << setw(12) << "MB"
+        << setw(12) << "Min s" << setw(12) << "Avg s" << setw(12) << "Max s" << endl;
+    for (int c = 0; c < CALL_COUNT; ++c) {
+        long long calls = 0, bytes = 0;
+        double min_s = 0.0, max_s = 0.0, sum_s = 0.0;
+        for (int r = 0; r < size; ++r) {
+            const CallStats& stats = ranks[r].per_call[c];
+            calls += stats.calls;
+            bytes += stats.bytes;
+            sum_s += stats.seconds;
+            min_s = (r == 0) ? stats.seconds : min(min_s, stats.seconds);
+            max_s = max(max_s, stats.seconds);
+        }
+        if (calls == 0)
+            continue;
+        out << left << setw(24) << CALL_NAMES[c] << right << setw(12) << calls << setprecision(2) << setw(12) << bytes / MB
+            << setprecision(6) << setw(12) << min_s << setw(12) << sum_s / size << setw(12) << max_s << endl;
+    }
+
+    out << "\n" << left << setw(24) << "Communicator" << setw(24) << "Function" << right << setw(12) << "Calls"
+        << setw(12) << "MB" << setw(12) << "Total s" << endl;
+    for (const auto& entry : per_target) {
+        out << left << setw(24) << entry.first.first << setw(24) << CALL_NAMES[entry.first.second] << right
+            << setw(12) << entry.second.calls << setprecision(2) << setw(12) << entry.second.bytes / MB
+            << setprecision(6) << setw(12) << entry.second.seconds << endl;
+    }
+
+    out << "\n" << left << setw(8) << "Rank" << right << setw(12) << "Wall s" << setw(12) << "MPI s" << setw(8) << "MPI %"
+        << setw(12) << "Calls" << setw(12) << "MB" << endl;
+    for (int r = 0; r < size; ++r) {
+        const RankSummary& rank = ranks[r];
+        out << left << setw(8) << r << right << setprecision(6) << setw(12) << rank.wall << setw(12) << rank.mpi_seconds
+            << setprecision(1) << setw(8) << (rank.wall > 0.0 ? 100.0 * rank.mpi_seconds / rank.wall : 0.0)
+            << setw(12) << rank.calls << setprecision(2) << setw(12) << rank.bytes / MB << endl;
+    }
+    out << "Times are inclusive time inside each call; MB counts the data passed through each rank's own buffers." << endl;
+    out << "==================================================" << endl;
+}
+
+int MPI_Finalize() {
+    int rank = 0, size = 0;
+    PMPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    PMPI_Comm_size(MPI_COMM_WORLD, &size);
+
+    string local = serializeProfile();
+    int length = local.size();
+    vector<int> lengths(size), displs(size, 0);
+    PMPI_Gather(&length, 1, MPI_INT, lengths.data(), 1, MPI_INT, 0, MPI_COMM_WORLD);
+    int total = 0;
+    if (rank == 0) {
+        for (int r = 0; r < size; ++r) {
+            displs[r] = total;
+            total += lengths[r];
+        }
+    }
+    string all(total, '\0');
+    PMPI_Gatherv(local.data(), length, MPI_CHAR, &all[0], lengths.data(), displs.data(), MPI_CHAR, 0, MPI_COMM_WORLD);
+
+    if (rank == 0) {
+        vector<RankSummary> ranks(size);
+        map<pair<string, int>, CallStats> per_target;
+        for (int r = 0; r < size; ++r) {
+            RankSummary& summary = ranks[r];
+            summary.wall = summary.mpi_seconds = 0.0;
+            summary.calls = summary.bytes = 0;
+            for (CallStats& stats : summary.per_call)
+                stats = {0, 0, 0.0};
+
+            istringstream lines(all.substr(displs[r], lengths[r]));
+            string line;
+            while (getline(lines, line)) {
+                istringstream fields(line);
+                string name;
+                getline(fields, name, '\t');
+                if (name == "wall") {
+                    fields >> summary.wall;
+                    continue;
+                }
+                int call = 0;
+                CallStats stats;
+                fields >> call >> stats.calls >> stats.bytes >> stats.seconds;
+                CallStats& rank_stats = summary.per_call[call];
+                rank_stats.calls += stats.calls;
+                rank_stats.bytes += stats.bytes;
+                rank_stats.seconds += stats.seconds;
+                summary.calls += stats.calls;
+                summary.bytes += stats.bytes;
+                summary.mpi_seconds += stats.seconds;
+                auto inserted = per_target.insert(make_pair(make_pair(name, call), stats));
+                if (!inserted.second) {
+                    inserted.first->second.calls += stats.calls;
+                    inserted.first->second.bytes += stats.bytes;
+                    inserted.first->second.seconds += stats.seconds;
+                }
+            }
+        }
+
+        const char* filename = getenv("MPI_PROFILE_FILE");
+        if (filename != nullptr && *filename != '\0') {
+            ofstream outfile(filename);
+            printProfile(outfile, ranks, per_target);
+            cout << "MPI profile stored in " << filename << endl;
+        } else {
+            printProfile(cout, ranks, per_target);
+        }
+    }
+    return PMPI_Finalize();
+}
@@ -0,0 +1,385 @@
+#include "../../include/utils/benchmark.h"
+#include "../../include/utils/data_utils.h"
+#include "../../include/utils/dataset_cache.h"
+#include "../../include/utils/phase_profile.h"
+#include "../../include/algorithms/quick_search.h"
+#include "../../include/algorithms/prime_finding.h"
+#include "../../include/algorithms/prime_counting.h"
+#include "../../include/algorithms/bitonic_sort.h"
+#include "../../include/algorithms/radix_sort.h"
+#include "../../include/algorithms/sample_sort.h"
+#include <vector>
+#include <string>
+#include <map>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <mpi.h>
+
+using namespace std;
+
+const int DEFAULT_REPETITIONS = 5;
+const int DEFAULT_WARMUP = 1;
+const string RANDOM_INPUT_PREFIX = "random:";
+
+struct BenchmarkJob {
+    string algorithm;
+    string input;
+    int repetitions = DEFAULT_REPETITIONS;
+    int warmup = DEFAULT_WARMUP;
+    map<string, long long> options;
+};
+
+struct BenchmarkResult {
+    BenchmarkJob job;
+    long long elements;
+    double min_time, median_time, p95_time, max_time, mean_time;
+};
+
+static bool isArrayAlgorithm(const string& algorithm) {
+    return algorithm == "search" || algorithm == "bitonic" || algorithm == "radix" || algorithm == "sample";
+}
+
+static bool isSortAlgorithm(const string& algorithm) {
+    return algorithm == "bitonic" || algorithm == "radix" || algorithm == "sample";
+}
+
+static bool isRangeAlgorithm(const string& algorithm) {
+    return algorithm == "primes" || algorithm == "primecount";
+}
+
+// Every rank parses the same spec text, so the job list needs no further communication.
+// Errors are reported by the root only.
+static bool parseJobSpec(const string& text, vector<BenchmarkJob>& jobs, int rank, int root_rank) {
+    istringstream lines(text);
+    string line;
+    int line_number = 0;
+    bool ok = true;
+    while (getline(lines, line)) {
+        line_number++;
+        line = line.substr(0, line.find('#'));
+        istringstream fields(line);
+        BenchmarkJob job;
+        if (!(fields >> job.algorithm))
+            continue;
+        string field;
+        vector<string> positional;
+        bool valid = static_cast<bool>(fields >> job.input);
+        while (valid && fields >> field) {
+            size_t eq = field.find('=');
+            if (eq == string::npos) {
+                positional.push_back(field);
+            } else {
+                job.options[field.substr(0, eq)] = atoll(field.c_str() + eq + 1);
+            }
+        }
+        if (positional.size() > 0) job.repetitions = atoi(positional[0].c_str());
+        if (positional.size() > 1) job.warmup = atoi(positional[1].c_str());
+        valid = valid && positional.size() <= 2 && job.repetitions > 0 && job.warmup >= 0
+                && (isArrayAlgorithm(job.algorithm) || isRangeAlgorithm(job.algorithm));
+        if (!valid) {
+            if (rank == root_rank)
+                cout << "Error: invalid benchmark job on line " << line_number << ": " << line << endl;
+            ok = false;
+            continue;
+        }
+        jobs.push_back(job);
+    }
+    return ok;
+}
+
+// `random:N` data: element i is a hash of i reduced to [0, key_range), so the dataset does not depend on the
+// process count.
+static vector<int> generateRandomData(long long global_size, long long key_range, int rank, int world_size) {
+    vector<long long> counts, displs;
+    computeBlockPartition(global_size, world_size, counts, displs);
+    vector<int> local_data(counts[rank]);
+    for (long long i = 0; i < counts[rank]; ++i) {
+        unsigned long long z = (unsigned long long)(displs[rank] + i) + 0x9e3779b97f4a7c15ULL;
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        z ^= z >> 31;
+        local_data[i] = (int)(z % (unsigned long long)key_range);
+    }
+    return local_data;
+}
+
+// Records keyed by the data, with the element's global index as payload (an argsort).
+static vector<IntIndexRecord> indexRecords(const vector<int>& local_data, MPI_Comm comm) {
+    long long local_count = local_data.size(), first_index = 0;
+    MPI_Exscan(&local_count, &first_index, 1, MPI_LONG_LONG, MPI_SUM, comm);
+    int rank;
+    MPI_Comm_rank(comm, &rank);
+    if (rank == 0)
+        first_index = 0;
+    vector<IntIndexRecord> records(local_data.size());
+    for (size_t i = 0; i < local_data.size(); ++i)
+        records[i] = {local_data[i], first_index + (long long)i};
+    return records;
+}
+
+// Comparator of the `descending=1` option, which runs the comparison sorts through their generic paths.
+template<typename T>
+struct KeyGreater {
+    bool operator()(const T& a, const T& b) const {
+        return sortKey(b) < sortKey(a);
+    }
+};
+
+template<typename T>
+static vector<T> runSort(const string& algorithm, const vector<T>& local_data, long long elements, int oversampling,
+                         bool descending, int rank, int world_size, MPI_Comm comm, bool gather_result) {
+    if (descending) {
+        if (algorithm == "bitonic")
+            return parallelBitonicSort<T, KeyGreater<T>>(local_data, elements, rank, world_size, comm, gather_result);
+        return parallelSampleSort<T, KeyGreater<T>>(local_data, elements, rank, world_size, comm, gather_result,
+                                                    oversampling);
+    }
+    if (algorithm == "bitonic")
+        return parallelBitonicSort(local_data, elements, rank, world_size, comm, gather_result);
+    if (algorithm == "radix")
+        return parallelRadixSort(local_data, elements, rank, world_size, comm, gather_result);
+    return parallelSampleSort(local_data, elements, rank, world_size, comm, gather_result, oversampling);
+}
+
+// Orders by key, then by payload, so that sorting input and output with it compares them as multisets.
+template<typename T>
+static bool elementLess(const T& a, const T& b) {
+    return a < b;
+}
+
+template<typename K, typename P>
+static bool elementLess(const SortRecord<K, P>& a, const SortRecord<K, P>& b) {
+    return a.key < b.key || (!(b.key < a.key) && a.payload < b.payload);
+}
+
+// Sorts once more with the result gathered and checks on the root that it is ordered by key (in the requested
+// direction) and holds exactly the input elements, payloads included. The verdict is known to every rank.
+template<typename T>
+static bool verifySort(const string& algorithm, const vector<T>& local_data, long long elements, int oversampling,
+                       bool descending, int root_rank, int rank, int world_size, MPI_Comm comm) {
+    vector<T> output = runSort(algorithm, local_data, elements, oversampling, descending, rank, world_size, comm, true);
+    vector<T> input = gatherDataGatherv(local_data, root_rank, rank, world_size, comm);
+    int valid = 1;
+    if (rank == root_rank) {
+        valid = (descending ? is_sorted(output.begin(), output.end(), KeyGreater<T>())
+                            : is_sorted(output.begin(), output.end(), KeyLess<T>()))
+                && output.size() == input.size();
+        auto less = [](const T& a, const T& b) { return elementLess(a, b); };
+        sort(input.begin(), input.end(), less);
+        sort(output.begin(), output.end(), less);
+        for (size_t i = 0; valid && i < output.size(); ++i)
+            valid = !elementLess(input[i], output[i]) && !elementLess(output[i], input[i]);
+    }
+    MPI_Bcast(&valid, 1, MPI_INT, root_rank, comm);
+    return valid == 1;
+}
+
+static double percentile(const vector<double>& sorted_times, double fraction) {
+    size_t rank = (size_t)ceil(fraction * sorted_times.size());
+    return sorted_times[max((size_t)1, rank) - 1];
+}
+
+// Runs warmup + repetitions of one job. Each repetition starts after a barrier and its time is the slowest
+// rank's, collected on the root. Algorithm output on the console is suppressed while the job runs.
+static bool runBenchmarkJob(const BenchmarkJob& job, int root_rank, int rank, int world_size, MPI_Comm comm,
+                            vector<double>& times, long long& elements) {
+    auto option = [&](const string& key, long long fallback) {
+        auto it = job.options.find(key);
+        return (it == job.options.end()) ? fallback : it->second;
+    };
+    int target = (int)option("target", -1);
+    int oversampling = (int)option("oversampling", 0);
+    bool records = option("records", 0) != 0;
+    bool verify = option("verify", 0) != 0;
+    bool descending = option("descending", 0) != 0;
+    if ((records || verify || descending) && !isSortAlgorithm(job.algorithm)) {
+        if (rank == root_rank)
+            cout << "Error: records, verify and descending apply to sort jobs only: " << job.algorithm << " "
+                 << job.input << endl;
+        return false;
+    }
+    if (descending && job.algorithm == "radix") {
+        if (rank == root_rank)
+            cout << "Error: radix sort has no comparator, descending applies to bitonic and sample only" << endl;
+        return false;
+    }
+
+    vector<int> generated;
+    const vector<int>* local_data = &generated;
+    long long lower = 0, upper = 0;
+    if (isArrayAlgorithm(job.algorithm)) {
+        if (job.input.compare(0, RANDOM_INPUT_PREFIX.size(), RANDOM_INPUT_PREFIX) == 0) {
+            elements = atoll(job.input.c_str() + RANDOM_INPUT_PREFIX.size());
+            long long key_range = option("keys", elements);
+            if (key_range <= 0)
+                elements = 0;
+            if (elements > 0)
+                generated = generateRandomData(elements, key_range, rank, world_size);
+        } else {
+            bool cache_hit = false;
+            local_data = &acquireDataset(job.input, root_rank, rank, world_size, comm, elements, cache_hit);
+        }
+    } else {
+        size_t colon = job.input.find(':');
+        lower = (colon == string::npos) ? 1 : atoll(job.input.c_str());
+        upper = atoll(job.input.c_str() + (colon == string::npos ? 0 : colon + 1));
+        elements = upper - lower + 1;
+    }
+    if (elements <= 0) {
+        if (rank == root_rank)
+            cout << "Error: no data for benchmark job " << job.algorithm << " " << job.input << endl;
+        return false;
+    }
+
+    vector<IntIndexRecord> local_records;
+    if (records)
+        local_records = indexRecords(*local_data, comm);
+
+    times.clear();
+    for (int iteration = 0; iteration < job.warmup + job.repetitions; ++iteration) {
+        if (rank == root_rank)
+            cout.setstate(ios::badbit);
+        MPI_Barrier(comm);
+        // The phase profile covers the timed repetitions only.
+        if (iteration == job.warmup)
+            resetPhaseProfile();
+        double start = MPI_Wtime();
+        if (job.algorithm == "search") {
+            parallelQuickSearch(*local_data, target, elements, rank, world_size, comm);
+        } else if (records) {
+            runSort(job.algorithm, local_records, elements, oversampling, descending, rank, world_size, comm, false);
+        } else if (isSortAlgorithm(job.algorithm)) {
+            runSort(job.algorithm, *local_data, elements, oversampling, descending, rank, world_size, comm, false);
+        } else if (job.algorithm == "primes") {
+            parallelPrimeFindingCompact(lower, upper, rank, world_size, comm, PRIME_RESULT_COUNT, "");
+        } else {
+            parallelPrimeCount(lower, upper, rank, world_size, comm);
+        }
+        double local_time = MPI_Wtime() - start;
+        if (rank == root_rank)
+            cout.clear();
+
+        double slowest = 0.0;
+        MPI_Reduce(&local_time, &slowest, 1, MPI_DOUBLE, MPI_MAX, root_rank, comm);
+        if (iteration >= job.warmup)
+            times.push_back(slowest);
+    }
+
+    if (verify) {
+        if (rank == root_rank)
+            cout.setstate(ios::badbit);
+        bool valid = records
+            ? verifySort(job.algorithm, local_records, elements, oversampling, descending,
+                         root_rank, rank, world_size, comm)
+            : verifySort(job.algorithm, *local_data, elements, oversampling, descending,
+                         root_rank, rank, world_size, comm);
+        if (rank == root_rank) {
+            cout.clear();
+            cout << "Verification of " << job.algorithm << " " << job.input << ": "
+                 << (valid ? "sorted permutation of the input" : "FAILED") << endl;
+        }
+        if (!valid)
+            return false;
+    }
+    return true;
+}
+
+static void writeBenchmarkResults(const vector<BenchmarkResult>& results, const string& csv_filename,
+                                  const string& json_filename, int world_size) {
+    ofstream csv(csv_filename);
+    csv << "algorithm,input,elements,processes,repetitions,warmup,min_s,median_s,p95_s,max_s,mean_s\n";
+    csv << setprecision(9);
+    for (const BenchmarkResult& r : results) {
+        csv << r.job.algorithm << "," << r.job.input << "," << r.elements << "," << world_size << ","
+            << r.job.repetitions << "," << r.job.warmup << "," << r.min_time << "," << r.median_time << ","
+            << r.p95_time << "," << r.max_time << "," << r.mean_time << "\n";
+    }
+
+    ofstream json(json_filename);
+    json << setprecision(9);
+    json << "{\n  \"processes\": " << world_size << ",\n  \"results\": [";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const BenchmarkResult& r = results[i];
+        json << (i == 0 ? "\n" : ",\n")
+             << "    {\"algorithm\": \"" << r.job.algorithm << "\", \"input\": \"" << r.job.input << "\", "
+             << "\"elements\": " << r.elements << ", \"repetitions\": " << r.job.repetitions << ", "
+             << "\"warmup\": " << r.job.warmup << ", \"min_s\": " << r.min_time << ", "
+             << "\"median_s\": " << r.median_time << ", \"p95_s\": " << r.p95_time << ", "
+             << "\"max_s\": " << r.max_time << ", \"mean_s\": " << r.mean_time << "}";
+    }
+    json << "\n  ]\n}\n";
+}
+
+int runBenchmarks(const string& spec_filename, const string& csv_filename, const string& json_filename,
+                  int root_rank, int rank, int world_size, MPI_Comm comm) {
+    string spec;
+    int readable = 1;
+    if (rank == root_rank) {
+        ifstream infile(spec_filename);
+        if (!infile) {
+            cout << "Error: Could not open benchmark job file: " << spec_filename << endl;
+            readable = 0;
+        }
+        stringstream buffer;
+        buffer << infile.rdbuf();
+        spec = buffer.str();
+    }
+    MPI_Bcast(&readable, 1, MPI_INT, root_rank, comm);
+    if (!readable)
+        return 1;
+    long long spec_length = spec.size();
+    MPI_Bcast(&spec_length, 1, MPI_LONG_LONG, root_rank, comm);
+    spec.resize(spec_length);
+    MPI_Bcast(&spec[0], spec_length, MPI_CHAR, root_rank, comm);
+
+    vector<BenchmarkJob> jobs;
+    bool ok = parseJobSpec(spec, jobs, rank, root_rank);
+
+    vector<BenchmarkResult> results;
+    for (const BenchmarkJob& job : jobs) {
+        vector<double> times;
+        long long elements = 0;
+        if (!runBenchmarkJob(job, root_rank, rank, world_size, comm, times, elements)) {
+            ok = false;
+            continue;
+        }
+        if (rank != root_rank) {
+            if (phaseProfileEnabled())
+                reportPhaseProfile(root_rank, rank, world_size, comm);
+            continue;
+        }
+
+        sort(times.begin(), times.end());
+        BenchmarkResult r;
+        r.job = job;
+        r.elements = elements;
+        r.min_time = times.front();
+        r.max_time = times.back();
+        size_t n = times.size();
+        r.median_time = (n % 2) ? times[n / 2] : (times[n / 2 - 1] + times[n / 2]) / 2;
+        r.p95_time = percentile(times, 0.95);
+        double sum = 0.0;
+        for (double t : times) sum += t;
+        r.mean_time = sum / n;
+        results.push_back(r);
+
+        cout << fixed << setprecision(6) << left << setw(10) << job.algorithm << " " << setw(28) << job.input
+             << right << " n=" << elements << " p=" << world_size << " reps=" << job.repetitions
+             << "  min " << r.min_time << "  median " << r.median_time << "  p95 " << r.p95_time
+             << "  max " << r.max_time << " s" << endl;
+        cout.unsetf(ios::floatfield);
+        if (phaseProfileEnabled())
+            reportPhaseProfile(root_rank, rank, world_size, comm);
+    }
+
+    if (rank == root_rank) {
+        writeBenchmarkResults(results, csv_filename, json_filename, world_size);
+        cout << "Benchmark results stored in " << csv_filename << " and " << json_filename << endl;
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,289 @@
+#include "../../include/utils/bitonic_kernels.h"
+#include "../../include/utils/local_sort.h"
+#include <vector>
+#include <algorithm>
+#include <climits>
+#include <cstring>
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#define BITONIC_X86_KERNELS 1
+#include <immintrin.h>
+#endif
+
+using namespace std;
+
+// A kernel sorts `width`-element register blocks in place and merges two sorted runs of any length.
+struct BitonicKernelOps {
+    const char* name;
+    size_t width;
+    void (*sort_blocks)(int* data, size_t n);
+    void (*merge)(const int* a, size_t a_size, const int* b, size_t b_size, int* out);
+};
+
+#ifdef BITONIC_X86_KERNELS
+
+// Runs shorter than a register are read with +infinity padding and only the real
+// part of the output is stored, so the vector merge accepts any run length.
+template <size_t WIDTH>
+static inline const int* paddedBlock(const int* src, size_t remaining, int* staging) {
+    if (remaining >= WIDTH)
+        return src;
+    memcpy(staging, src, remaining * sizeof(int));
+    fill(staging + remaining, staging + WIDTH, INT_MAX);
+    return staging;
+}
+
+template <size_t WIDTH>
+static inline void storeBlock(int* out, size_t produced, size_t total, const int* block) {
+    size_t count = min(WIDTH, total - min(total, produced));
+    memcpy(out + produced, block, count * sizeof(int));
+}
+
+#pragma GCC push_options
+#pragma GCC target("avx2")
+
+// Lanes whose mask bit is set take the maximum of the pair (i, i ^ j).
+#define AVX2_STEP(v, partner, mask) \
+    _mm256_blend_epi32(_mm256_min_epi32(v, partner), _mm256_max_epi32(v, partner), mask)
+#define AVX2_SWAP1(v) _mm256_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1))
+#define AVX2_SWAP2(v) _mm256_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2))
+#define AVX2_SWAP4(v) _mm256_permute2x128_si256(v, v, 1)
+
+static inline __m256i avx2CleanBitonic(__m256i v) {
+    v = AVX2_STEP(v, AVX2_SWAP4(v), 0xF0);
+    v = AVX2_STEP(v, AVX2_SWAP2(v), 0xCC);
+    v = AVX2_STEP(v, AVX2_SWAP1(v), 0xAA);
+    return v;
+}
+
+static inline __m256i avx2SortBlock(__m256i v) {
+    v = AVX2_STEP(v, AVX2_SWAP1(v), 0x66);
+    v = AVX2_STEP(v, AVX2_SWAP2(v), 0x3C);
+    v = AVX2_STEP(v, AVX2_SWAP1(v), 0x5A);
+    return avx2CleanBitonic(v);
+}
+
+// Both inputs sorted ascending; on return lo holds the 8 smallest and hi the 8 largest, both sorted.
+static inline void avx2MergeBlocks(__m256i a, __m256i b, __m256i& lo, __m256i& hi) {
+    __m256i reversed = _mm256_permutevar8x32_epi32(b, _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0));
+    lo = avx2CleanBitonic(_mm256_min_epi32(a, reversed));
+    hi = avx2CleanBitonic(_mm256_max_epi32(a, reversed));
+}
+
+static void avx2SortBlocks(int* data, size_t n) {
+    for (size_t i = 0; i + 8 <= n; i += 8) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)(data + i));
+        _mm256_storeu_si256((__m256i*)(data + i), avx2SortBlock(v));
+    }
+}
+
+static void avx2Merge(const int* a, size_t a_size, const int* b, size_t b_size, int* out) {
+    alignas(32) int staging[8];
+    alignas(32) int block[8];
+    size_t total = a_size + b_size;
+    size_t ia = 0, ib = 0, produced = 0;
+    __m256i lo, hi;
+
+    __m256i va = _mm256_loadu_si256((const __m256i*)paddedBlock<8>(a, a_size, staging));
+    ia += 8;
+    __m256i vb = _mm256_loadu_si256((const __m256i*)paddedBlock<8>(b, b_size, staging));
+    ib += 8;
+    avx2MergeBlocks(va, vb, lo, hi);
+    _mm256_store_si256((__m256i*)block, lo);
+    storeBlock<8>(out, produced, total, block);
+    produced += 8;
+
+    while (ia < a_size || ib < b_size) {
+        bool take_a = (ib >= b_size) || (ia < a_size && a[ia] <= b[ib]);
+        __m256i next;
+        if (take_a) {
+            next = _mm256_loadu_si256((const __m256i*)paddedBlock<8>(a + ia, a_size - ia, staging));
+            ia += 8;
+        } else {
+            next = _mm256_loadu_si256((const __m256i*)paddedBlock<8>(b + ib, b_size - ib, staging));
+            ib += 8;
+        }
+        avx2MergeBlocks(next, hi, lo, hi);
+        if (produced + 8 <= total) {
+            _mm256_storeu_si256((__m256i*)(out + produced), lo);
+        } else {
+            _mm256_store_si256((__m256i*)block, lo);
+            storeBlock<8>(out, produced, total, block);
+        }
+        produced += 8;
+    }
+    _mm256_store_si256((__m256i*)block, hi);
+    storeBlock<8>(out, produced, total, block);
+}
+
+#undef AVX2_STEP
+#undef AVX2_SWAP1
+#undef AVX2_SWAP2
+#undef AVX2_SWAP4
+#pragma GCC pop_options
+
+#pragma GCC push_options
+#pragma GCC target("avx512f")
+
+// The zero-masking forms with every lane selected compile to the same instructions as the plain intrinsics, whose
+// undefined pass-through operand GCC 12 reports as uninitialized.
+const __mmask16 AVX512_ALL = 0xFFFF;
+#define AVX512_STEP(v, partner, mask) \
+    _mm512_mask_blend_epi32(mask, _mm512_maskz_min_epi32(AVX512_ALL, v, partner), \
+                            _mm512_maskz_max_epi32(AVX512_ALL, v, partner))
+#define AVX512_SWAP1(v) _mm512_maskz_shuffle_epi32(AVX512_ALL, v, (_MM_PERM_ENUM)_MM_SHUFFLE(2, 3, 0, 1))
+#define AVX512_SWAP2(v) _mm512_maskz_shuffle_epi32(AVX512_ALL, v, (_MM_PERM_ENUM)_MM_SHUFFLE(1, 0, 3, 2))
+#define AVX512_SWAP4(v) _mm512_maskz_shuffle_i32x4(AVX512_ALL, v, v, _MM_SHUFFLE(2, 3, 0, 1))
+#define AVX512_SWAP8(v) _mm512_maskz_shuffle_i32x4(AVX512_ALL, v, v, _MM_SHUFFLE(1, 0, 3, 2))
+
+static inline __m512i avx512CleanBitonic(__m512i v) {
+    v = AVX512_STEP(v, AVX512_SWAP8(v), 0xFF00);
+    v = AVX512_STEP(v, AVX512_SWAP4(v), 0xF0F0);
+    v = AVX512_STEP(v, AVX512_SWAP2(v), 0xCCCC);
+    v = AVX512_STEP(v, AVX512_SWAP1(v), 0xAAAA);
+    return v;
+}
+
+static inline __m512i avx512SortBlock(__m512i v) {
+    v = AVX512_STEP(v, AVX512_SWAP1(v), 0x6666);
+    v = AVX512_STEP(v, AVX512_SWAP2(v), 0x3C3C);
+    v = AVX512_STEP(v, AVX512_SWAP1(v), 0x5A5A);
+    v = AVX512_STEP(v, AVX512_SWAP4(v), 0x0FF0);
+    v = AVX512_STEP(v, AVX512_SWAP2(v), 0x33CC);
+    v = AVX512_STEP(v, AVX512_SWAP1(v), 0x55AA);
+    return avx512CleanBitonic(v);
+}
+
+static inline void avx512MergeBlocks(__m512i a, __m512i b, __m512i& lo, __m512i& hi) {
+    __m512i reversed = _mm512_maskz_permutexvar_epi32(
+        AVX512_ALL, _mm512_setr_epi32(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0), b);
+    lo = avx512CleanBitonic(_mm512_maskz_min_epi32(AVX512_ALL, a, reversed));
+    hi = avx512CleanBitonic(_mm512_maskz_max_epi32(AVX512_ALL, a, reversed));
+}
+
+static void avx512SortBlocks(int* data, size_t n) {
+    for (size_t i = 0; i + 16 <= n; i += 16) {
+        __m512i v = _mm512_loadu_si512(data + i);
+        _mm512_storeu_si512(data + i, avx512SortBlock(v));
+    }
+}
+
+static void avx512Merge(const int* a, size_t a_size, const int* b, size_t b_size, int* out) {
+    alignas(64) int staging[16];
+    alignas(64) int block[16];
+    size_t total = a_size + b_size;
+    size_t ia = 0, ib = 0, produced = 0;
+    __m512i lo, hi;
+
+    __m512i va = _mm512_loadu_si512(paddedBlock<16>(a, a_size, staging));
+    ia += 16;
+    __m512i vb = _mm512_loadu_si512(paddedBlock<16>(b, b_size, staging));
+    ib += 16;
+    avx512MergeBlocks(va, vb, lo, hi);
+    _mm512_store_si512(block, lo);
+    storeBlock<16>(out, produced, total, block);
+    produced += 16;
+
+    while (ia < a_size || ib < b_size) {
+        bool take_a = (ib >= b_size) || (ia < a_size && a[ia] <= b[ib]);
+        __m512i next;
+        if (take_a) {
+            next = _mm512_loadu_si512(paddedBlock<16>(a + ia, a_size - ia, staging));
+            ia += 16;
+        } else {
+            next = _mm512_loadu_si512(paddedBlock<16>(b + ib, b_size - ib, staging));
+            ib += 16;
+        }
+        avx512MergeBlocks(next, hi, lo, hi);
+        if (produced + 16 <= total) {
+            _mm512_storeu_si512(out + produced, lo);
+        } else {
+            _mm512_store_si512(block, lo);
+            storeBlock<16>(out, produced, total, block);
+        }
+        produced += 16;
+    }
+    _mm512_store_si512(block, hi);
+    storeBlock<16>(out, produced, total, block);
+}
+
+#undef AVX512_STEP
+#undef AVX512_SWAP1
+#undef AVX512_SWAP2
+#undef AVX512_SWAP4
+#undef AVX512_SWAP8
+#pragma GCC pop_options
+
+#endif
+
+static void scalarMerge(const int* a, size_t a_size, const int* b, size_t b_size, int* out) {
+    merge(a, a + a_size, b, b + b_size, out);
+}
+
+static const BitonicKernelOps& selectBitonicKernel() {
+    static const BitonicKernelOps scalar_ops = {"scalar", 1, nullptr, scalarMerge};
+#ifdef BITONIC_X86_KERNELS
+    static const BitonicKernelOps avx2_ops = {"AVX2", 8, avx2SortBlocks, avx2Merge};
+    static const BitonicKernelOps avx512_ops = {"AVX-512", 16, avx512SortBlocks, avx512Merge};
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f"))
+        return avx512_ops;
+    if (__builtin_cpu_supports("avx2"))
+        return avx2_ops;
+#endif
+    return scalar_ops;
+}
+
+static const BitonicKernelOps& bitonicKernel() {
+    static const BitonicKernelOps& ops = selectBitonicKernel();
+    return ops;
+}
+
+const char* bitonicKernelName() {
+    return bitonicKernel().name;
+}
+
+void bitonicMergeKernel(const int* a, size_t a_size, const int* b, size_t b_size, int* out) {
+    if (a_size == 0 || b_size == 0) {
+        memcpy(out, a_size ? a : b, (a_size + b_size) * sizeof(int));
+        return;
+    }
+    bitonicKernel().merge(a, a_size, b, b_size, out);
+}
+
+// Register blocks are sorted with a bitonic network, then merged bottom-up with the vector merge.
+// The data is padded with +infinity to a whole number of blocks, so every run is a multiple of the
+// register width; the padding sorts to the end and is dropped afterwards.
+void bitonicSortKernel(vector<int>& data, vector<int>& scratch) {
+    const BitonicKernelOps& ops = bitonicKernel();
+    size_t n = data.size();
+    if (ops.sort_blocks == nullptr) {
+        localSort(data.data(), n, scratch);
+        return;
+    }
+    if (n < 2)
+        return;
+
+    size_t padded = (n + ops.width - 1) / ops.width * ops.width;
+    data.resize(padded, INT_MAX);
+    scratch.resize(padded);
+    ops.sort_blocks(data.data(), padded);
+
+    int* src = data.data();
+    int* dst = scratch.data();
+    for (size_t width = ops.width; width < padded; width *= 2) {
+        for (size_t left = 0; left < padded; left += 2 * width) {
+            size_t mid = min(left + width, padded);
+            size_t right = min(left + 2 * width, padded);
+            if (mid == right) {
+                memcpy(dst + left, src + left, (right - left) * sizeof(int));
+            } else {
+                ops.merge(src + left, mid - left, src + mid, right - mid, dst + left);
+            }
+        }
+        swap(src, dst);
+    }
+    if (src != data.data())
+        memcpy(data.data(), src, padded * sizeof(int));
+    data.resize(n);
+}
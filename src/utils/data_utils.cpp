@@ -1,13 +1,19 @@
 #include "../../include/utils/data_utils.h"
+#include "../../include/utils/mpi_large_count.h"
 #include <fstream>
 #include <vector>
 #include <string>
 #include <iostream>
+#include <cstring>
+#include <climits>
+#include <algorithm>
 #include <mpi.h>
 
 using namespace std;
 
-vector<int> readFileData(const string& filename, int root_rank, int rank, MPI_Comm comm, int& out_global_size) {
+const long long MAX_IO_CHUNK_BYTES = 1 << 30;
+
+vector<int> readFileData(const string& filename, int root_rank, int rank, MPI_Comm comm, long long& out_global_size) {
     vector<int> data;
     out_global_size = 0;
     if (rank == root_rank) {
@@ -23,67 +29,367 @@ vector<int> readFileData(const string& filename, int root_rank, int rank, MPI_Co
             out_global_size = data.size();
         }
     }
-    MPI_Bcast(&out_global_size, 1, MPI_INT, root_rank, comm);
+    MPI_Bcast(&out_global_size, 1, MPI_LONG_LONG, root_rank, comm);
     return data;
 }
 
-void distributeDataScatterv(const vector<int>& global_data, vector<int>& local_data,
-                           int root_rank, int rank, int world_size, MPI_Comm comm) {
-    int global_size = 0;
-    if (rank == root_rank) {
-        global_size = global_data.size();
+void computeBlockPartition(long long global_size, int world_size, vector<long long>& counts, vector<long long>& displs) {
+    counts.resize(world_size);
+    displs.resize(world_size);
+    long long chunk_size = global_size / world_size;
+    long long remainder = global_size % world_size;
+
+    for (int i = 0; i < world_size; ++i) {
+        counts[i] = chunk_size + (i < remainder ? 1 : 0);
+        displs[i] = (i == 0) ? 0 : displs[i - 1] + counts[i - 1];
+    }
+}
+
+// Every rank reads the header and then only its own slice with a collective MPI_File_read_at_all,
+// so no rank ever holds the whole file. Returns false (on every rank) if the file is not in the binary format.
+bool readBinaryFileDistributed(const string& filename, vector<int>& local_data,
+                               int root_rank, int rank, int world_size, MPI_Comm comm, long long& out_global_size) {
+    out_global_size = 0;
+    local_data.clear();
+
+    MPI_File fh;
+    if (MPI_File_open(comm, filename.c_str(), MPI_MODE_RDONLY, MPI_INFO_NULL, &fh) != MPI_SUCCESS) {
+        return false;
+    }
+
+    unsigned char header[BINARY_HEADER_BYTES] = {0};
+    MPI_File_read_at_all(fh, 0, header, BINARY_HEADER_BYTES, MPI_BYTE, MPI_STATUS_IGNORE);
+
+    unsigned int element_bytes = 0;
+    unsigned long long element_count = 0;
+    memcpy(&element_bytes, header + 4, sizeof(element_bytes));
+    memcpy(&element_count, header + 8, sizeof(element_count));
+    if (memcmp(header, "PCDB", 4) != 0 || (element_bytes != 4 && element_bytes != 8)) {
+        MPI_File_close(&fh);
+        return false;
+    }
+    vector<long long> counts, displs;
+    computeBlockPartition(element_count, world_size, counts, displs);
+    MPI_Offset offset = BINARY_HEADER_BYTES + (MPI_Offset)displs[rank] * element_bytes;
+
+    int local_ok = 1;
+    local_data.resize(counts[rank]);
+    if (element_bytes == 4) {
+        largeFileReadAtAll(fh, offset, local_data.data(), counts[rank], MPI_INT, comm);
+    } else {
+        vector<long long> wide(counts[rank]);
+        largeFileReadAtAll(fh, offset, wide.data(), counts[rank], MPI_LONG_LONG, comm);
+        for (long long i = 0; i < counts[rank]; ++i) {
+            if (wide[i] < INT_MIN || wide[i] > INT_MAX)
+                local_ok = 0;
+            local_data[i] = (int)wide[i];
+        }
     }
-    MPI_Bcast(&global_size, 1, MPI_INT, root_rank, comm);
+    MPI_File_close(&fh);
 
-    if (global_size == 0) {
+    int all_ok = 0;
+    MPI_Allreduce(&local_ok, &all_ok, 1, MPI_INT, MPI_MIN, comm);
+    if (!all_ok) {
+        if (rank == root_rank) {
+            cout << "Error: Binary file contains values outside the 32-bit integer range." << endl;
+        }
         local_data.clear();
-        return;
+        return true;
+    }
+
+    out_global_size = element_count;
+    return true;
+}
+
+// Independent reads of a contiguous byte range, split so no single call exceeds the int count limit.
+static void readByteRange(MPI_File fh, MPI_Offset offset, long long length, char* buffer) {
+    while (length > 0) {
+        int chunk = (int)min(length, MAX_IO_CHUNK_BYTES);
+        MPI_File_read_at(fh, offset, buffer, chunk, MPI_CHAR, MPI_STATUS_IGNORE);
+        offset += chunk;
+        buffer += chunk;
+        length -= chunk;
+    }
+}
+
+static inline bool isSpaceByte(unsigned char c) {
+    return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+// Converts the leading digit run of an 8-byte little-endian block (SWAR) and reports its length.
+static inline unsigned long long parseDigitBlock(unsigned long long block, int& digit_count) {
+    unsigned long long digits = block - 0x3030303030303030ULL;
+    unsigned long long non_digit = (digits | (digits + 0x7676767676767676ULL)) & 0x8080808080808080ULL;
+    digit_count = non_digit ? __builtin_ctzll(non_digit) / 8 : 8;
+    if (digit_count == 0)
+        return 0;
+    digits <<= 8 * (8 - digit_count);
+    digits = digits * 10 + (digits >> 8);
+    digits = (((digits & 0x000000FF000000FFULL) * (100 + (1000000ULL << 32))) +
+              (((digits >> 16) & 0x000000FF000000FFULL) * (1 + (10000ULL << 32)))) >> 32;
+    return digits;
+}
+
+// Parses whitespace-separated integers from [begin, end). Returns false on a malformed or out-of-range token.
+static bool parseIntegers(const char* begin, const char* end, vector<int>& values) {
+    const char* p = begin;
+    while (true) {
+        while (p < end && isSpaceByte(*p))
+            p++;
+        if (p == end)
+            return true;
+
+        bool negative = (*p == '-');
+        p += (*p == '-' || *p == '+');
+        const char* digits = p;
+        while (p < end && *p == '0')
+            p++;
+        const char* significant = p;
+        long long value = 0;
+        if (end - p >= 8) {
+            unsigned long long block;
+            memcpy(&block, p, sizeof(block));
+            int digit_count;
+            value = parseDigitBlock(block, digit_count);
+            p += digit_count;
+        }
+        unsigned int digit;
+        while (p < end && (digit = (unsigned char)*p - '0') < 10 && p - significant < 11) {
+            value = value * 10 + digit;
+            p++;
+        }
+        value = negative ? -value : value;
+        if (p == digits || (p < end && !isSpaceByte(*p)) || value < INT_MIN || value > INT_MAX)
+            return false;
+        values.push_back((int)value);
+    }
+}
+
+// Every rank reads roughly file_size / world_size bytes. A rank owns the numbers that start inside its byte range;
+// the start of the first number owned by each rank is shared so every rank knows where its last number ends.
+// The parsed values are then moved into the same block partition distributeDataScatterv produces.
+bool readTextFileDistributed(const string& filename, vector<int>& local_data,
+                             int root_rank, int rank, int world_size, MPI_Comm comm, long long& out_global_size) {
+    out_global_size = 0;
+    local_data.clear();
+
+    MPI_File fh;
+    if (MPI_File_open(comm, filename.c_str(), MPI_MODE_RDONLY, MPI_INFO_NULL, &fh) != MPI_SUCCESS) {
+        if (rank == root_rank) {
+            cout << "Error: Could not open input file: " << filename << endl;
+        }
+        return false;
+    }
+
+    MPI_Offset file_size = 0;
+    MPI_File_get_size(fh, &file_size);
+    MPI_Offset range_start = file_size * rank / world_size;
+    MPI_Offset range_end = file_size * (rank + 1) / world_size;
+
+    // One byte before the range tells whether the range begins in the middle of a number.
+    MPI_Offset read_start = (range_start > 0) ? range_start - 1 : 0;
+    vector<char> buffer(range_end - read_start);
+    readByteRange(fh, read_start, buffer.size(), buffer.data());
+
+    long long first_start = file_size;
+    for (MPI_Offset pos = range_start; pos < range_end; ++pos) {
+        bool previous_space = (pos == 0) || isSpaceByte(buffer[pos - 1 - read_start]);
+        if (previous_space && !isSpaceByte(buffer[pos - read_start])) {
+            first_start = pos;
+            break;
+        }
+    }
+
+    vector<long long> all_first_starts(world_size);
+    MPI_Allgather(&first_start, 1, MPI_LONG_LONG, all_first_starts.data(), 1, MPI_LONG_LONG, comm);
+    long long parse_end = file_size;
+    for (int i = world_size - 1; i > rank; --i) {
+        parse_end = min(parse_end, all_first_starts[i]);
+    }
+
+    // The last number may run past the range; fetch the bytes up to the next owned number.
+    if (parse_end > range_end) {
+        buffer.resize(parse_end - read_start);
+        readByteRange(fh, range_end, parse_end - range_end, buffer.data() + (range_end - read_start));
+    }
+    MPI_File_close(&fh);
+
+    vector<int> parsed;
+    int local_ok = 1;
+    if (first_start < parse_end) {
+        parsed.reserve((parse_end - first_start) / 8);
+        local_ok = parseIntegers(buffer.data() + (first_start - read_start),
+                                 buffer.data() + (parse_end - read_start), parsed) ? 1 : 0;
+    }
+    vector<char>().swap(buffer);
+
+    int all_ok = 0;
+    MPI_Allreduce(&local_ok, &all_ok, 1, MPI_INT, MPI_MIN, comm);
+    if (!all_ok) {
+        if (rank == root_rank) {
+            cout << "Error: Input file contains a token that is not a 32-bit integer: " << filename << endl;
+        }
+        return true;
     }
 
-    vector<int> sendcounts(world_size);
-    vector<int> displs(world_size);
-    int chunk_size = global_size / world_size;
-    int remainder = global_size % world_size;
+    long long parsed_count = parsed.size();
+    vector<long long> all_parsed_counts(world_size);
+    MPI_Allgather(&parsed_count, 1, MPI_LONG_LONG, all_parsed_counts.data(), 1, MPI_LONG_LONG, comm);
+    long long total_count = 0;
+    vector<long long> parsed_displs(world_size);
+    for (int i = 0; i < world_size; ++i) {
+        parsed_displs[i] = total_count;
+        total_count += all_parsed_counts[i];
+    }
+    vector<long long> counts, displs;
+    computeBlockPartition(total_count, world_size, counts, displs);
 
+    // Intersect the parsed ranges with the target blocks to get both sides of the exchange.
+    vector<long long> sendcounts(world_size), sdispls(world_size), recvcounts(world_size), rdispls(world_size);
     for (int i = 0; i < world_size; ++i) {
-        sendcounts[i] = chunk_size + (i < remainder ? 1 : 0);
-        displs[i] = (i == 0) ? 0 : displs[i - 1] + sendcounts[i - 1];
+        long long send_lo = max(parsed_displs[rank], displs[i]);
+        long long send_hi = min(parsed_displs[rank] + parsed_count, displs[i] + counts[i]);
+        sendcounts[i] = max(0LL, send_hi - send_lo);
+        sdispls[i] = (sendcounts[i] > 0) ? send_lo - parsed_displs[rank] : 0;
+
+        long long recv_lo = max(parsed_displs[i], displs[rank]);
+        long long recv_hi = min(parsed_displs[i] + all_parsed_counts[i], displs[rank] + counts[rank]);
+        recvcounts[i] = max(0LL, recv_hi - recv_lo);
+        rdispls[i] = (recvcounts[i] > 0) ? recv_lo - displs[rank] : 0;
     }
 
-    local_data.resize(sendcounts[rank]);
-    MPI_Scatterv(global_data.data(), sendcounts.data(), displs.data(), MPI_INT,
-                 local_data.data(), sendcounts[rank], MPI_INT,
-                 root_rank, comm);
+    local_data.resize(counts[rank]);
+    largeAlltoallv(parsed.data(), sendcounts, sdispls, local_data.data(), recvcounts, rdispls, MPI_INT, comm);
+
+    out_global_size = total_count;
+    return true;
 }
 
-vector<int> gatherDataGatherv(const vector<int>& local_data,
-                             int root_rank, int rank, int world_size, MPI_Comm comm) {
-    int local_size = local_data.size();
-    vector<int> recvcounts;
-    if (rank == root_rank) {
-        recvcounts.resize(world_size);
+bool loadDistributedData(const string& filename, vector<int>& local_data,
+                         int root_rank, int rank, int world_size, MPI_Comm comm, long long& out_global_size) {
+    if (readBinaryFileDistributed(filename, local_data, root_rank, rank, world_size, comm, out_global_size)) {
+        return out_global_size > 0;
     }
 
-    MPI_Gather(&local_size, 1, MPI_INT,
-               (rank == root_rank) ? recvcounts.data() : nullptr, 1, MPI_INT,
-               root_rank, comm);
+    readTextFileDistributed(filename, local_data, root_rank, rank, world_size, comm, out_global_size);
+    return out_global_size > 0;
+}
 
-    vector<int> global_data;
-    vector<int> displs;
-    int total_size = 0;
-    if (rank == root_rank) {
-        displs.resize(world_size);
-        for (int i = 0; i < world_size; ++i) {
-            displs[i] = (i == 0) ? 0 : displs[i - 1] + recvcounts[i - 1];
-            total_size += recvcounts[i];
+// Appends the decimal form of value to out and returns the new end.
+static char* formatInteger(int value, char* out) {
+    unsigned int magnitude = (value < 0) ? 0u - (unsigned int)value : (unsigned int)value;
+    char digits[10];
+    int length = 0;
+    do {
+        digits[length++] = '0' + magnitude % 10;
+        magnitude /= 10;
+    } while (magnitude > 0);
+    if (value < 0)
+        *out++ = '-';
+    while (length > 0)
+        *out++ = digits[--length];
+    return out;
+}
+
+// Each rank writes its slice at the exclusive prefix sum of the byte counts before it, so the file is
+// identical to what gathering to rank 0 and writing serially would produce (space-separated text, or the binary input format).
+bool writeDistributedData(const string& filename, const vector<int>& local_data, bool binary,
+                          int root_rank, int rank, MPI_Comm comm) {
+    vector<char> text;
+    if (!binary) {
+        long long local_count = local_data.size();
+        long long preceding_count = 0;
+        MPI_Exscan(&local_count, &preceding_count, 1, MPI_LONG_LONG, MPI_SUM, comm);
+        if (rank == 0)
+            preceding_count = 0;
+        text.resize(local_data.size() * 12);
+        char* out = text.data();
+        for (size_t i = 0; i < local_data.size(); ++i) {
+            if (preceding_count + (long long)i > 0)
+                *out++ = ' ';
+            out = formatInteger(local_data[i], out);
+        }
+        text.resize(out - text.data());
+    }
+
+    long long local_bytes = binary ? (long long)local_data.size() * sizeof(int) : (long long)text.size();
+    long long byte_offset = 0;
+    long long total_bytes = 0;
+    MPI_Exscan(&local_bytes, &byte_offset, 1, MPI_LONG_LONG, MPI_SUM, comm);
+    if (rank == 0)
+        byte_offset = 0;
+    MPI_Allreduce(&local_bytes, &total_bytes, 1, MPI_LONG_LONG, MPI_SUM, comm);
+
+    MPI_File fh;
+    if (MPI_File_open(comm, filename.c_str(), MPI_MODE_CREATE | MPI_MODE_WRONLY, MPI_INFO_NULL, &fh) != MPI_SUCCESS) {
+        if (rank == root_rank) {
+            cout << "Error: Could not open output file: " << filename << endl;
         }
-        global_data.resize(total_size);
+        return false;
     }
 
-    MPI_Gatherv(local_data.data(), local_size, MPI_INT,
-                (rank == root_rank) ? global_data.data() : nullptr,
-                (rank == root_rank) ? recvcounts.data() : nullptr,
-                (rank == root_rank) ? displs.data() : nullptr,
-                MPI_INT, root_rank, comm);
-    return global_data;
-}
\ No newline at end of file
+    MPI_Offset header_bytes = binary ? BINARY_HEADER_BYTES : 0;
+    MPI_File_set_size(fh, header_bytes + total_bytes);
+    if (binary && rank == root_rank) {
+        unsigned char header[BINARY_HEADER_BYTES];
+        unsigned int element_bytes = sizeof(int);
+        unsigned long long element_count = total_bytes / sizeof(int);
+        memcpy(header, "PCDB", 4);
+        memcpy(header + 4, &element_bytes, sizeof(element_bytes));
+        memcpy(header + 8, &element_count, sizeof(element_count));
+        MPI_File_write_at(fh, 0, header, BINARY_HEADER_BYTES, MPI_BYTE, MPI_STATUS_IGNORE);
+    }
+
+    // Every rank must join each collective write, so ranks with less data pad with empty writes.
+    const char* bytes = binary ? reinterpret_cast<const char*>(local_data.data()) : text.data();
+    long long local_rounds = (local_bytes + MAX_IO_CHUNK_BYTES - 1) / MAX_IO_CHUNK_BYTES;
+    long long rounds = 0;
+    MPI_Allreduce(&local_rounds, &rounds, 1, MPI_LONG_LONG, MPI_MAX, comm);
+    for (long long r = 0; r < rounds; ++r) {
+        long long done = r * MAX_IO_CHUNK_BYTES;
+        int chunk = (int)max(0LL, min(local_bytes - done, MAX_IO_CHUNK_BYTES));
+        MPI_File_write_at_all(fh, header_bytes + byte_offset + done, chunk > 0 ? bytes + done : nullptr,
+                              chunk, MPI_BYTE, MPI_STATUS_IGNORE);
+    }
+    MPI_File_close(&fh);
+    return true;
+}
+
+static inline unsigned long long mixChecksumValue(int value) {
+    unsigned long long z = (unsigned long long)(unsigned int)value + 0x9E3779B97F4A7C15ULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+// Order-independent checksum of the distributed multiset, equal on every rank.
+unsigned long long distributedChecksum(const vector<int>& local_data, MPI_Comm comm) {
+    unsigned long long local_sum = 0;
+    for (int value : local_data) {
+        local_sum += mixChecksumValue(value);
+    }
+    unsigned long long global_sum = 0;
+    MPI_Allreduce(&local_sum, &global_sum, 1, MPI_UNSIGNED_LONG_LONG, MPI_SUM, comm);
+    return global_sum;
+}
+
+// True on every rank if each slice is sorted and no slice starts below the last element of an earlier non-empty slice.
+bool isDistributedSorted(const vector<int>& local_data, int rank, int world_size, MPI_Comm comm) {
+    int local_bounds[3] = {local_data.empty() ? 0 : 1,
+                           local_data.empty() ? 0 : local_data.front(),
+                           local_data.empty() ? 0 : local_data.back()};
+    vector<int> all_bounds(3 * world_size);
+    MPI_Allgather(local_bounds, 3, MPI_INT, all_bounds.data(), 3, MPI_INT, comm);
+
+    int local_ok = is_sorted(local_data.begin(), local_data.end()) ? 1 : 0;
+    for (int i = rank - 1; i >= 0 && local_bounds[0]; --i) {
+        if (all_bounds[3 * i]) {
+            if (all_bounds[3 * i + 2] > local_bounds[1])
+                local_ok = 0;
+            break;
+        }
+    }
+    int all_ok = 0;
+    MPI_Allreduce(&local_ok, &all_ok, 1, MPI_INT, MPI_MIN, comm);
+    return all_ok == 1;
+}
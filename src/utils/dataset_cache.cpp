@@ -0,0 +1,112 @@
+#include "../../include/utils/dataset_cache.h"
+#include "../../include/utils/data_utils.h"
+#include <vector>
+#include <string>
+#include <map>
+#include <utility>
+#include <iostream>
+#include <iomanip>
+#include <sys/stat.h>
+#include <mpi.h>
+
+using namespace std;
+
+struct CachedDataset {
+    long long file_size;
+    long long mtime_ns;
+    long long global_size;
+    vector<int> local_data;
+};
+
+// One registry per process; every rank holds its own block of each dataset under the same keys.
+static map<string, CachedDataset> dataset_registry;
+
+// Size and modification time of the file on the root, shared with every rank so they all make the same
+// hit-or-miss decision. Returns false if the root cannot stat the file.
+static bool fileIdentity(const string& filename, int root_rank, int rank, MPI_Comm comm,
+                         long long& file_size, long long& mtime_ns) {
+    long long identity[3] = {0, 0, 0};
+    if (rank == root_rank) {
+        struct stat st;
+        if (stat(filename.c_str(), &st) == 0) {
+            identity[0] = 1;
+            identity[1] = st.st_size;
+            identity[2] = (long long)st.st_mtim.tv_sec * 1000000000LL + st.st_mtim.tv_nsec;
+        }
+    }
+    MPI_Bcast(identity, 3, MPI_LONG_LONG, root_rank, comm);
+    file_size = identity[1];
+    mtime_ns = identity[2];
+    return identity[0] == 1;
+}
+
+const vector<int>& acquireDataset(const string& filename, int root_rank, int rank, int world_size, MPI_Comm comm,
+                                  long long& out_global_size, bool& cache_hit) {
+    static const vector<int> no_data;
+    long long file_size = 0, mtime_ns = 0;
+    bool exists = fileIdentity(filename, root_rank, rank, comm, file_size, mtime_ns);
+
+    auto it = dataset_registry.find(filename);
+    if (exists && it != dataset_registry.end() && it->second.file_size == file_size && it->second.mtime_ns == mtime_ns) {
+        cache_hit = true;
+        out_global_size = it->second.global_size;
+        return it->second.local_data;
+    }
+    if (it != dataset_registry.end())
+        dataset_registry.erase(it);
+
+    cache_hit = false;
+    CachedDataset entry;
+    entry.file_size = file_size;
+    entry.mtime_ns = mtime_ns;
+    loadDistributedData(filename, entry.local_data, root_rank, rank, world_size, comm, entry.global_size);
+    out_global_size = entry.global_size;
+    // Failed or empty loads are not kept, so the next run reports the problem again.
+    if (!exists || entry.global_size == 0)
+        return no_data;
+    entry.local_data.shrink_to_fit();
+    CachedDataset& stored = dataset_registry[filename];
+    stored = move(entry);
+    return stored.local_data;
+}
+
+bool evictDataset(const string& filename) {
+    return dataset_registry.erase(filename) > 0;
+}
+
+void evictAllDatasets() {
+    dataset_registry.clear();
+}
+
+// Prints, on the root, every resident dataset with the largest and average memory it holds per rank.
+void reportDatasetCache(int root_rank, int rank, int world_size, MPI_Comm comm) {
+    const double MB = 1024.0 * 1024.0;
+    if (rank == root_rank) {
+        cout << "Resident datasets: " << dataset_registry.size() << endl;
+    }
+    long long total_bytes = 0;
+    for (const auto& entry : dataset_registry) {
+        long long bytes = entry.second.local_data.capacity() * sizeof(int);
+        total_bytes += bytes;
+        long long max_bytes = 0, sum_bytes = 0;
+        MPI_Reduce(&bytes, &max_bytes, 1, MPI_LONG_LONG, MPI_MAX, root_rank, comm);
+        MPI_Reduce(&bytes, &sum_bytes, 1, MPI_LONG_LONG, MPI_SUM, root_rank, comm);
+        if (rank == root_rank) {
+            cout << "  " << entry.first << ": " << entry.second.global_size << " elements, "
+                 << fixed << setprecision(2) << "max " << max_bytes / MB << " MB per rank, average "
+                 << sum_bytes / MB / world_size << " MB per rank" << endl;
+            cout.unsetf(ios::floatfield);
+        }
+    }
+
+    long long max_total = 0, min_total = 0, sum_total = 0;
+    MPI_Reduce(&total_bytes, &max_total, 1, MPI_LONG_LONG, MPI_MAX, root_rank, comm);
+    MPI_Reduce(&total_bytes, &min_total, 1, MPI_LONG_LONG, MPI_MIN, root_rank, comm);
+    MPI_Reduce(&total_bytes, &sum_total, 1, MPI_LONG_LONG, MPI_SUM, root_rank, comm);
+    if (rank == root_rank) {
+        cout << "Memory held per rank: min " << fixed << setprecision(2) << min_total / MB << " MB, max "
+             << max_total / MB << " MB; total " << sum_total / MB << " MB over " << world_size << " ranks" << endl;
+        cout.unsetf(ios::floatfield);
+        cout << setprecision(6);
+    }
+}
@@ -0,0 +1,74 @@
+#include "../../include/utils/kway_merge.h"
+#include <vector>
+#include <cstring>
+#include <cstdint>
+#include <algorithm>
+
+using namespace std;
+
+// A tree entry packs the run's head value (sign bit flipped, so unsigned order is signed order) above the run
+// index. Entries are then distinct, compare in one instruction, and equal values leave in run order, which keeps
+// the merge stable. An exhausted run is represented by the largest possible entry.
+const uint64_t EXHAUSTED_RUN = UINT64_MAX;
+
+static inline uint64_t runEntry(int value, size_t run) {
+    return ((uint64_t)((uint32_t)value ^ 0x80000000u) << 32) | run;
+}
+
+static inline int entryValue(uint64_t entry) {
+    return (int)((uint32_t)(entry >> 32) ^ 0x80000000u);
+}
+
+// Fills tree[node] with the loser of the match played at that node and returns the winner.
+static uint64_t buildLoserTree(vector<uint64_t>& tree, const vector<uint64_t>& leaves, size_t node, size_t leaf_count) {
+    if (node >= leaf_count)
+        return leaves[node - leaf_count];
+    uint64_t left = buildLoserTree(tree, leaves, 2 * node, leaf_count);
+    uint64_t right = buildLoserTree(tree, leaves, 2 * node + 1, leaf_count);
+    tree[node] = max(left, right);
+    return min(left, right);
+}
+
+// Stable merge of sorted runs, run i being data[run_displs[i], run_displs[i] + run_counts[i]), written straight
+// into `out`. A loser tree over the runs picks each output with log2(k) comparisons against the stored losers,
+// walking only the path from the refilled leaf to the root.
+void kWayMerge(const int* data, const vector<long long>& run_counts, const vector<long long>& run_displs, int* out) {
+    vector<const int*> heads, ends;
+    size_t total = 0;
+    for (size_t i = 0; i < run_counts.size(); ++i) {
+        if (run_counts[i] > 0) {
+            heads.push_back(data + run_displs[i]);
+            ends.push_back(data + run_displs[i] + run_counts[i]);
+            total += run_counts[i];
+        }
+    }
+    size_t runs = heads.size();
+    if (runs == 0)
+        return;
+    if (runs == 1) {
+        memcpy(out, heads[0], total * sizeof(int));
+        return;
+    }
+
+    size_t leaf_count = 1;
+    while (leaf_count < runs)
+        leaf_count *= 2;
+    vector<uint64_t> leaves(leaf_count, EXHAUSTED_RUN);
+    for (size_t r = 0; r < runs; ++r)
+        leaves[r] = runEntry(*heads[r]++, r);
+    vector<uint64_t> tree(leaf_count);
+    uint64_t winner = buildLoserTree(tree, leaves, 1, leaf_count);
+
+    for (size_t i = 0; i < total; ++i) {
+        out[i] = entryValue(winner);
+        size_t run = (size_t)(winner & 0xffffffffu);
+        uint64_t entry = (heads[run] < ends[run]) ? runEntry(*heads[run]++, run) : EXHAUSTED_RUN;
+        for (size_t node = (run + leaf_count) / 2; node > 0; node /= 2) {
+            uint64_t loser = tree[node];
+            bool swap_in = loser < entry;
+            tree[node] = swap_in ? entry : loser;
+            entry = swap_in ? loser : entry;
+        }
+        winner = entry;
+    }
+}
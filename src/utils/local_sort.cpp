@@ -0,0 +1,86 @@
+#include "../../include/utils/local_sort.h"
+#include <vector>
+#include <cstring>
+#include <algorithm>
+
+using namespace std;
+
+// Runs up to this length are insertion sorted before any merging.
+const size_t INSERTION_RUN = 32;
+// Blocks of this many ints (128 KB) are sorted completely while they are still in cache.
+const size_t CACHE_BLOCK = 1 << 15;
+
+static void insertionSort(int* data, size_t n) {
+    for (size_t i = 1; i < n; ++i) {
+        int value = data[i];
+        size_t j = i;
+        while (j > 0 && data[j - 1] > value) {
+            data[j] = data[j - 1];
+            --j;
+        }
+        data[j] = value;
+    }
+}
+
+// Stable merge of [a, a_end) and [b, b_end) into out, choosing with arithmetic instead of a data-dependent branch.
+static void mergeRuns(const int* a, const int* a_end, const int* b, const int* b_end, int* out) {
+    while (a < a_end && b < b_end) {
+        int x = *a, y = *b;
+        bool take_b = y < x;
+        *out++ = take_b ? y : x;
+        a += !take_b;
+        b += take_b;
+    }
+    memcpy(out, a, (a_end - a) * sizeof(int));
+    out += a_end - a;
+    memcpy(out, b, (b_end - b) * sizeof(int));
+}
+
+// One bottom-up level: merges neighbouring sorted runs of `width` elements from src into dst.
+static void mergeLevel(const int* src, int* dst, size_t n, size_t width) {
+    for (size_t left = 0; left < n; left += 2 * width) {
+        size_t mid = min(left + width, n);
+        size_t right = min(left + 2 * width, n);
+        if (mid == right || src[mid - 1] <= src[mid]) {
+            memcpy(dst + left, src + left, (right - left) * sizeof(int));
+        } else {
+            mergeRuns(src + left, src + mid, src + mid, src + right, dst + left);
+        }
+    }
+}
+
+// Bottom-up merge of runs of `width` in data, ping-ponging with scratch; the result always ends in data.
+static void mergeFromWidth(int* data, int* scratch, size_t n, size_t width) {
+    int* src = data;
+    int* dst = scratch;
+    for (; width < n; width *= 2) {
+        mergeLevel(src, dst, n, width);
+        swap(src, dst);
+    }
+    if (src != data)
+        memcpy(data, src, n * sizeof(int));
+}
+
+// Insertion-sorted runs feed a bottom-up merge sort. Each cache-sized block is finished before the
+// merges that span blocks, so the early levels never leave cache. Only the caller's scratch is used.
+void localSort(int* data, size_t n, vector<int>& scratch) {
+    if (n <= INSERTION_RUN) {
+        insertionSort(data, n);
+        return;
+    }
+    if (scratch.size() < n)
+        scratch.resize(n);
+
+    for (size_t block = 0; block < n; block += CACHE_BLOCK) {
+        size_t block_n = min(CACHE_BLOCK, n - block);
+        for (size_t run = 0; run < block_n; run += INSERTION_RUN)
+            insertionSort(data + block + run, min(INSERTION_RUN, block_n - run));
+        mergeFromWidth(data + block, scratch.data() + block, block_n, INSERTION_RUN);
+    }
+    mergeFromWidth(data, scratch.data(), n, CACHE_BLOCK);
+}
+
+void localSort(vector<int>& data) {
+    vector<int> scratch;
+    localSort(data.data(), data.size(), scratch);
+}
@@ -0,0 +1,191 @@
+#include "../../include/utils/mpi_large_count.h"
+#include "../../include/utils/phase_profile.h"
+#include <vector>
+#include <climits>
+#include <algorithm>
+#include <mpi.h>
+
+using namespace std;
+
+// Elements per message or I/O call when a count does not fit in an int (1 GB of ints).
+const long long LARGE_COUNT_CHUNK = 1 << 28;
+const int LARGE_COUNT_TAG = 0x4C43;
+
+static bool fitsInInt(const vector<long long>& values) {
+    for (long long value : values) {
+        if (value > INT_MAX)
+            return false;
+    }
+    return true;
+}
+
+static vector<int> toIntCounts(const vector<long long>& values) {
+    return vector<int>(values.begin(), values.end());
+}
+
+// Every rank must take the same path, since the fallback replaces a collective with point-to-point messages.
+static bool allFitInInt(bool local_fits, MPI_Comm comm) {
+    int local_flag = local_fits ? 1 : 0;
+    int all_flag = 0;
+    MPI_Allreduce(&local_flag, &all_flag, 1, MPI_INT, MPI_MIN, comm);
+    return all_flag == 1;
+}
+
+// Elements of `counts` addressed to or from ranks other than `rank`.
+static long long remoteCount(const vector<long long>& counts, int rank) {
+    long long total = 0;
+    for (size_t peer = 0; peer < counts.size(); ++peer) {
+        if ((int)peer != rank)
+            total += counts[peer];
+    }
+    return total;
+}
+
+// Charges the bytes a collective moves between this rank and the others to the current phase.
+static void countTransfer(long long sent, long long received, MPI_Datatype type) {
+    int type_size;
+    MPI_Type_size(type, &type_size);
+    countPhaseBytes(sent * type_size, received * type_size);
+}
+
+#if MPI_VERSION >= 4
+static vector<MPI_Count> toMpiCounts(const vector<long long>& values) {
+    return vector<MPI_Count>(values.begin(), values.end());
+}
+
+static vector<MPI_Aint> toMpiDispls(const vector<long long>& values) {
+    return vector<MPI_Aint>(values.begin(), values.end());
+}
+#endif
+
+// Posts a message of `count` elements as a series of messages of at most LARGE_COUNT_CHUNK elements.
+// Chunks between one pair of ranks share a tag and are matched in order.
+static void postChunked(bool is_send, const void* buf, long long count, MPI_Datatype type, int peer,
+                        MPI_Comm comm, vector<MPI_Request>& requests) {
+    MPI_Aint lower_bound, extent;
+    MPI_Type_get_extent(type, &lower_bound, &extent);
+    char* bytes = (char*)buf;
+    for (long long done = 0; done < count; done += LARGE_COUNT_CHUNK) {
+        int n = (int)min(count - done, LARGE_COUNT_CHUNK);
+        requests.emplace_back();
+        if (is_send)
+            MPI_Isend(bytes + done * extent, n, type, peer, LARGE_COUNT_TAG, comm, &requests.back());
+        else
+            MPI_Irecv(bytes + done * extent, n, type, peer, LARGE_COUNT_TAG, comm, &requests.back());
+    }
+}
+
+void largeAlltoallv(const void* sendbuf, const vector<long long>& sendcounts, const vector<long long>& sdispls,
+                    void* recvbuf, const vector<long long>& recvcounts, const vector<long long>& rdispls,
+                    MPI_Datatype type, MPI_Comm comm) {
+    if (phaseProfileEnabled()) {
+        int rank;
+        MPI_Comm_rank(comm, &rank);
+        countTransfer(remoteCount(sendcounts, rank), remoteCount(recvcounts, rank), type);
+    }
+#if MPI_VERSION >= 4
+    vector<MPI_Count> sc = toMpiCounts(sendcounts), rc = toMpiCounts(recvcounts);
+    vector<MPI_Aint> sd = toMpiDispls(sdispls), rd = toMpiDispls(rdispls);
+    MPI_Alltoallv_c(sendbuf, sc.data(), sd.data(), type, recvbuf, rc.data(), rd.data(), type, comm);
+#else
+    bool local_fits = fitsInInt(sendcounts) && fitsInInt(sdispls) && fitsInInt(recvcounts) && fitsInInt(rdispls);
+    if (allFitInInt(local_fits, comm)) {
+        vector<int> sc = toIntCounts(sendcounts), sd = toIntCounts(sdispls);
+        vector<int> rc = toIntCounts(recvcounts), rd = toIntCounts(rdispls);
+        MPI_Alltoallv(sendbuf, sc.data(), sd.data(), type, recvbuf, rc.data(), rd.data(), type, comm);
+        return;
+    }
+
+    MPI_Aint lower_bound, extent;
+    MPI_Type_get_extent(type, &lower_bound, &extent);
+    vector<MPI_Request> requests;
+    for (size_t peer = 0; peer < recvcounts.size(); ++peer)
+        postChunked(false, (char*)recvbuf + rdispls[peer] * extent, recvcounts[peer], type, peer, comm, requests);
+    for (size_t peer = 0; peer < sendcounts.size(); ++peer)
+        postChunked(true, (const char*)sendbuf + sdispls[peer] * extent, sendcounts[peer], type, peer, comm, requests);
+    MPI_Waitall(requests.size(), requests.data(), MPI_STATUSES_IGNORE);
+#endif
+}
+
+void largeGatherv(const void* sendbuf, long long sendcount, void* recvbuf,
+                  const vector<long long>& recvcounts, const vector<long long>& displs,
+                  MPI_Datatype type, int root, MPI_Comm comm) {
+    int rank;
+    MPI_Comm_rank(comm, &rank);
+    if (phaseProfileEnabled())
+        countTransfer((rank == root) ? 0 : sendcount, (rank == root) ? remoteCount(recvcounts, rank) : 0, type);
+#if MPI_VERSION >= 4
+    vector<MPI_Count> rc = toMpiCounts(recvcounts);
+    vector<MPI_Aint> rd = toMpiDispls(displs);
+    MPI_Gatherv_c(sendbuf, sendcount, type, recvbuf, (rank == root) ? rc.data() : nullptr,
+                  (rank == root) ? rd.data() : nullptr, type, root, comm);
+#else
+    bool local_fits = sendcount <= INT_MAX && (rank != root || (fitsInInt(recvcounts) && fitsInInt(displs)));
+    if (allFitInInt(local_fits, comm)) {
+        vector<int> rc = toIntCounts(recvcounts), rd = toIntCounts(displs);
+        MPI_Gatherv(sendbuf, (int)sendcount, type, recvbuf, (rank == root) ? rc.data() : nullptr,
+                    (rank == root) ? rd.data() : nullptr, type, root, comm);
+        return;
+    }
+
+    vector<MPI_Request> requests;
+    if (rank == root) {
+        MPI_Aint lower_bound, extent;
+        MPI_Type_get_extent(type, &lower_bound, &extent);
+        for (size_t peer = 0; peer < recvcounts.size(); ++peer)
+            postChunked(false, (char*)recvbuf + displs[peer] * extent, recvcounts[peer], type, peer, comm, requests);
+    }
+    postChunked(true, sendbuf, sendcount, type, root, comm, requests);
+    MPI_Waitall(requests.size(), requests.data(), MPI_STATUSES_IGNORE);
+#endif
+}
+
+void largeScatterv(const void* sendbuf, const vector<long long>& sendcounts, const vector<long long>& displs,
+                   void* recvbuf, long long recvcount, MPI_Datatype type, int root, MPI_Comm comm) {
+    int rank;
+    MPI_Comm_rank(comm, &rank);
+    if (phaseProfileEnabled())
+        countTransfer((rank == root) ? remoteCount(sendcounts, rank) : 0, (rank == root) ? 0 : recvcount, type);
+#if MPI_VERSION >= 4
+    vector<MPI_Count> sc = toMpiCounts(sendcounts);
+    vector<MPI_Aint> sd = toMpiDispls(displs);
+    MPI_Scatterv_c(sendbuf, (rank == root) ? sc.data() : nullptr, (rank == root) ? sd.data() : nullptr, type,
+                   recvbuf, recvcount, type, root, comm);
+#else
+    bool local_fits = recvcount <= INT_MAX && (rank != root || (fitsInInt(sendcounts) && fitsInInt(displs)));
+    if (allFitInInt(local_fits, comm)) {
+        vector<int> sc = toIntCounts(sendcounts), sd = toIntCounts(displs);
+        MPI_Scatterv(sendbuf, (rank == root) ? sc.data() : nullptr, (rank == root) ? sd.data() : nullptr, type,
+                     recvbuf, (int)recvcount, type, root, comm);
+        return;
+    }
+
+    vector<MPI_Request> requests;
+    postChunked(false, recvbuf, recvcount, type, root, comm, requests);
+    if (rank == root) {
+        MPI_Aint lower_bound, extent;
+        MPI_Type_get_extent(type, &lower_bound, &extent);
+        for (size_t peer = 0; peer < sendcounts.size(); ++peer)
+            postChunked(true, (const char*)sendbuf + displs[peer] * extent, sendcounts[peer], type, peer, comm, requests);
+    }
+    MPI_Waitall(requests.size(), requests.data(), MPI_STATUSES_IGNORE);
+#endif
+}
+
+// Collective read split into calls of at most LARGE_COUNT_CHUNK elements. Every rank must join each call,
+// so ranks with less to read pad with empty reads.
+void largeFileReadAtAll(MPI_File fh, MPI_Offset offset, void* buf, long long count,
+                        MPI_Datatype type, MPI_Comm comm) {
+    MPI_Aint lower_bound, extent;
+    MPI_Type_get_extent(type, &lower_bound, &extent);
+    long long local_rounds = (count + LARGE_COUNT_CHUNK - 1) / LARGE_COUNT_CHUNK;
+    long long rounds = 0;
+    MPI_Allreduce(&local_rounds, &rounds, 1, MPI_LONG_LONG, MPI_MAX, comm);
+    char* bytes = (char*)buf;
+    for (long long r = 0; r < rounds; ++r) {
+        long long done = r * LARGE_COUNT_CHUNK;
+        int n = (int)max(0LL, min(count - done, LARGE_COUNT_CHUNK));
+        MPI_File_read_at_all(fh, offset + done * extent, n > 0 ? bytes + done * extent : nullptr,
+                             n, type, MPI_STATUS_IGNORE);
+    }
+}
@@ -2,13 +2,15 @@
 #include <iostream>
 #include <iomanip>
 #include <string>
+#include <vector>
+#include <algorithm>
 #include <mpi.h>
 
 using namespace std;
 
 
 
-void analyzeAndPrintPerformance(const string& algo_name, int data_size,
+void analyzeAndPrintPerformance(const string& algo_name, long long data_size,
                                 int num_processes, double time_taken, int rank, MPI_Comm comm) {
     if (rank == 0) { 
         cout << "\n--- Performance Analysis for " << algo_name << " ---" << endl;
@@ -18,4 +20,33 @@ void analyzeAndPrintPerformance(const string& algo_name, int data_size,
         cout << "Time Taken: " << time_taken << " seconds (" << time_taken * 1000.0 << " ms)" << endl;
         cout << "--------------------------------------------------" << endl;
     }
-}
\ No newline at end of file
+}
+
+void reportPerRankTimes(const string& label, double local_time, long long local_items,
+                        int rank, int world_size, MPI_Comm comm) {
+    vector<double> times;
+    vector<long long> items;
+    if (rank == 0) {
+        times.resize(world_size);
+        items.resize(world_size);
+    }
+    MPI_Gather(&local_time, 1, MPI_DOUBLE, (rank == 0) ? times.data() : nullptr, 1, MPI_DOUBLE, 0, comm);
+    MPI_Gather(&local_items, 1, MPI_LONG_LONG, (rank == 0) ? items.data() : nullptr, 1, MPI_LONG_LONG, 0, comm);
+
+    if (rank == 0) {
+        double min_time = *min_element(times.begin(), times.end());
+        double max_time = *max_element(times.begin(), times.end());
+        double avg_time = 0.0;
+        for (double t : times) avg_time += t;
+        avg_time /= world_size;
+
+        cout << "\n--- " << label << " per Rank ---" << endl;
+        cout << fixed << setprecision(6);
+        for (int i = 0; i < world_size; ++i) {
+            cout << "Rank " << i << ": " << times[i] << " seconds (" << items[i] << " work items)" << endl;
+        }
+        cout << "Min / Avg / Max: " << min_time << " / " << avg_time << " / " << max_time << " seconds" << endl;
+        cout << setprecision(3) << "Imbalance (max/avg): " << (avg_time > 0.0 ? max_time / avg_time : 1.0) << endl;
+        cout << "--------------------------------------------------" << endl;
+    }
+}
@@ -0,0 +1,239 @@
+#include "../../include/utils/phase_profile.h"
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <mpi.h>
+
+using namespace std;
+
+struct PhaseStats {
+    string name;
+    long long calls;
+    double seconds;
+    long long bytes_sent;
+    long long bytes_received;
+    long long elements;
+};
+
+struct PhaseEvent {
+    int phase;
+    double start;
+    double duration;
+    long long bytes_sent;
+    long long bytes_received;
+    long long elements;
+};
+
+// One profile per process. Phases keep the order in which they were first opened.
+static bool profile_enabled = false;
+static double profile_origin = 0.0;
+static vector<PhaseStats> phase_stats;
+static map<string, int> phase_ids;
+static vector<PhaseEvent> phase_events;
+static vector<int> open_events;
+
+ScopedPhase::ScopedPhase(const char* name) : active(profile_enabled) {
+    if (!active)
+        return;
+    auto it = phase_ids.find(name);
+    if (it == phase_ids.end()) {
+        it = phase_ids.insert(make_pair(string(name), (int)phase_stats.size())).first;
+        phase_stats.push_back({name, 0, 0.0, 0, 0, 0});
+    }
+    open_events.push_back(phase_events.size());
+    phase_events.push_back({it->second, MPI_Wtime(), 0.0, 0, 0, 0});
+}
+
+ScopedPhase::~ScopedPhase() {
+    close();
+}
+
+void ScopedPhase::close() {
+    if (!active || open_events.empty())
+        return;
+    active = false;
+    PhaseEvent& event = phase_events[open_events.back()];
+    open_events.pop_back();
+    event.duration = MPI_Wtime() - event.start;
+    PhaseStats& stats = phase_stats[event.phase];
+    stats.calls++;
+    stats.seconds += event.duration;
+    stats.bytes_sent += event.bytes_sent;
+    stats.bytes_received += event.bytes_received;
+    stats.elements += event.elements;
+}
+
+void enablePhaseProfile(bool enabled) {
+    profile_enabled = enabled;
+}
+
+bool phaseProfileEnabled() {
+    return profile_enabled;
+}
+
+void resetPhaseProfile() {
+    phase_stats.clear();
+    phase_ids.clear();
+    phase_events.clear();
+    open_events.clear();
+    profile_origin = MPI_Wtime();
+}
+
+void countPhaseBytes(long long sent, long long received) {
+    if (!profile_enabled || open_events.empty())
+        return;
+    PhaseEvent& event = phase_events[open_events.back()];
+    event.bytes_sent += sent;
+    event.bytes_received += received;
+}
+
+void countPhaseElements(long long elements) {
+    if (!profile_enabled || open_events.empty())
+        return;
+    phase_events[open_events.back()].elements += elements;
+}
+
+// Concatenation of the text of every rank, in rank order, on the root.
+static string gatherText(const string& local, int root_rank, int rank, int world_size, MPI_Comm comm) {
+    int length = local.size();
+    vector<int> lengths(world_size), displs(world_size, 0);
+    MPI_Gather(&length, 1, MPI_INT, lengths.data(), 1, MPI_INT, root_rank, comm);
+    int total = 0;
+    if (rank == root_rank) {
+        for (int r = 0; r < world_size; ++r) {
+            displs[r] = total;
+            total += lengths[r];
+        }
+    }
+    string all(total, '\0');
+    MPI_Gatherv(local.data(), length, MPI_CHAR, &all[0], lengths.data(), displs.data(), MPI_CHAR, root_rank, comm);
+    return all;
+}
+
+// Names of the phases seen on any rank, in order of first appearance on the lowest rank, known to every rank.
+static vector<string> unionPhaseNames(int root_rank, int rank, int world_size, MPI_Comm comm) {
+    string local;
+    for (const PhaseStats& stats : phase_stats)
+        local += stats.name + "\n";
+    string all = gatherText(local, root_rank, rank, world_size, comm);
+
+    string merged;
+    if (rank == root_rank) {
+        map<string, bool> seen;
+        istringstream lines(all);
+        string name;
+        while (getline(lines, name)) {
+            if (!seen[name]) {
+                seen[name] = true;
+                merged += name + "\n";
+            }
+        }
+    }
+    long long merged_length = merged.size();
+    MPI_Bcast(&merged_length, 1, MPI_LONG_LONG, root_rank, comm);
+    merged.resize(merged_length);
+    MPI_Bcast(&merged[0], merged_length, MPI_CHAR, root_rank, comm);
+
+    vector<string> names;
+    istringstream lines(merged);
+    string name;
+    while (getline(lines, name))
+        names.push_back(name);
+    return names;
+}
+
+void reportPhaseProfile(int root_rank, int rank, int world_size, MPI_Comm comm) {
+    vector<string> names = unionPhaseNames(root_rank, rank, world_size, comm);
+    if (names.empty())
+        return;
+
+    // A phase a rank never entered counts as zero time and zero work on that rank.
+    const int COUNTERS = 3;
+    size_t n = names.size();
+    vector<double> seconds(n, 0.0);
+    vector<long long> counters(n * COUNTERS, 0);
+    for (size_t p = 0; p < n; ++p) {
+        auto it = phase_ids.find(names[p]);
+        if (it == phase_ids.end())
+            continue;
+        const PhaseStats& stats = phase_stats[it->second];
+        seconds[p] = stats.seconds;
+        counters[p * COUNTERS] = stats.elements;
+        counters[p * COUNTERS + 1] = stats.bytes_sent;
+        counters[p * COUNTERS + 2] = stats.bytes_received;
+    }
+
+    vector<double> min_seconds(n), max_seconds(n), sum_seconds(n);
+    vector<long long> min_counters(n * COUNTERS), max_counters(n * COUNTERS), sum_counters(n * COUNTERS);
+    MPI_Reduce(seconds.data(), min_seconds.data(), n, MPI_DOUBLE, MPI_MIN, root_rank, comm);
+    MPI_Reduce(seconds.data(), max_seconds.data(), n, MPI_DOUBLE, MPI_MAX, root_rank, comm);
+    MPI_Reduce(seconds.data(), sum_seconds.data(), n, MPI_DOUBLE, MPI_SUM, root_rank, comm);
+    MPI_Reduce(counters.data(), min_counters.data(), n * COUNTERS, MPI_LONG_LONG, MPI_MIN, root_rank, comm);
+    MPI_Reduce(counters.data(), max_counters.data(), n * COUNTERS, MPI_LONG_LONG, MPI_MAX, root_rank, comm);
+    MPI_Reduce(counters.data(), sum_counters.data(), n * COUNTERS, MPI_LONG_LONG, MPI_SUM, root_rank, comm);
+    if (rank != root_rank)
+        return;
+
+    const double MB = 1024.0 * 1024.0;
+    cout << "\n--- Phase Profile (" << world_size << " processes) ---" << endl;
+    cout << left << setw(24) << "Phase" << right << setw(11) << "Min s" << setw(11) << "Avg s" << setw(11) << "Max s"
+         << setw(11) << "Imbalance" << setw(14) << "Elements min" << setw(14) << "Elements max"
+         << setw(12) << "Sent MB" << setw(12) << "Recv MB" << endl;
+    for (size_t p = 0; p < n; ++p) {
+        double avg = sum_seconds[p] / world_size;
+        cout << left << setw(24) << names[p] << right << fixed << setprecision(6)
+             << setw(11) << min_seconds[p] << setw(11) << avg << setw(11) << max_seconds[p]
+             << setprecision(3) << setw(11) << (avg > 0.0 ? max_seconds[p] / avg : 1.0)
+             << setw(14) << min_counters[p * COUNTERS] << setw(14) << max_counters[p * COUNTERS]
+             << setprecision(2) << setw(12) << sum_counters[p * COUNTERS + 1] / MB
+             << setw(12) << sum_counters[p * COUNTERS + 2] / MB << endl;
+    }
+    cout << "Imbalance is max / avg time over the ranks; bytes are totals over all ranks." << endl;
+    cout << "--------------------------------------------------" << endl;
+    cout.unsetf(ios::floatfield);
+    cout << setprecision(6);
+}
+
+bool writePhaseTrace(const string& filename, int root_rank, int rank, int world_size, MPI_Comm comm) {
+    // Complete ("X") events in microseconds; pid 0 and one tid per rank put every rank on its own timeline.
+    // Ranks reset the profile right after a barrier, so their timelines line up up to the barrier's skew.
+    ostringstream local;
+    local << fixed << setprecision(3);
+    for (const PhaseEvent& event : phase_events) {
+        local << "{\"name\": \"" << phase_stats[event.phase].name << "\", \"ph\": \"X\", \"pid\": 0, \"tid\": " << rank
+              << ", \"ts\": " << (event.start - profile_origin) * 1e6 << ", \"dur\": " << event.duration * 1e6
+              << ", \"args\": {\"elements\": " << event.elements << ", \"bytes_sent\": " << event.bytes_sent
+              << ", \"bytes_received\": " << event.bytes_received << "}}\n";
+    }
+    string all = gatherText(local.str(), root_rank, rank, world_size, comm);
+
+    int written = 0;
+    if (rank == root_rank) {
+        ofstream outfile(filename);
+        if (outfile.is_open()) {
+            outfile << "{\"traceEvents\": [\n";
+            for (int r = 0; r < world_size; ++r) {
+                outfile << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 0, \"tid\": " << r
+                        << ", \"args\": {\"name\": \"Rank " << r << "\"}}";
+                outfile << ((r + 1 < world_size || !all.empty()) ? ",\n" : "\n");
+            }
+            istringstream lines(all);
+            string line;
+            bool first = true;
+            while (getline(lines, line)) {
+                outfile << (first ? "" : ",\n") << line;
+                first = false;
+            }
+            outfile << "\n], \"displayTimeUnit\": \"ms\"}\n";
+            written = 1;
+        } else {
+            cout << "Error: Could not open trace file: " << filename << endl;
+        }
+    }
+    MPI_Bcast(&written, 1, MPI_INT, root_rank, comm);
+    return written == 1;
+}
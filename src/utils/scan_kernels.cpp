@@ -0,0 +1,145 @@
+#include "../../include/utils/scan_kernels.h"
+#include <cstddef>
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#define SCAN_X86_KERNELS 1
+#include <immintrin.h>
+#endif
+
+using namespace std;
+
+// A kernel returns the position of the first element equal to `value` (or n), or counts such elements.
+// The scans are memory-bandwidth bound, so the vector kernels compare four registers per iteration
+// and only look for the matching lane once the combined mask is non-zero.
+struct ScanKernelOps {
+    const char* name;
+    size_t (*find_first)(const int* data, size_t n, int value);
+    size_t (*count)(const int* data, size_t n, int value);
+};
+
+static size_t scalarFindFirst(const int* data, size_t n, int value) {
+    for (size_t i = 0; i < n; ++i) {
+        if (data[i] == value)
+            return i;
+    }
+    return n;
+}
+
+static size_t scalarCount(const int* data, size_t n, int value) {
+    size_t count = 0;
+    for (size_t i = 0; i < n; ++i)
+        count += (data[i] == value);
+    return count;
+}
+
+#ifdef SCAN_X86_KERNELS
+
+#pragma GCC push_options
+#pragma GCC target("avx2,popcnt")
+
+static size_t avx2FindFirst(const int* data, size_t n, int value) {
+    const __m256i needle = _mm256_set1_epi32(value);
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i e0 = _mm256_cmpeq_epi32(_mm256_loadu_si256((const __m256i*)(data + i)), needle);
+        __m256i e1 = _mm256_cmpeq_epi32(_mm256_loadu_si256((const __m256i*)(data + i + 8)), needle);
+        __m256i e2 = _mm256_cmpeq_epi32(_mm256_loadu_si256((const __m256i*)(data + i + 16)), needle);
+        __m256i e3 = _mm256_cmpeq_epi32(_mm256_loadu_si256((const __m256i*)(data + i + 24)), needle);
+        __m256i any = _mm256_or_si256(_mm256_or_si256(e0, e1), _mm256_or_si256(e2, e3));
+        if (!_mm256_testz_si256(any, any)) {
+            unsigned long long mask = (unsigned)_mm256_movemask_ps(_mm256_castsi256_ps(e0))
+                                    | (unsigned)_mm256_movemask_ps(_mm256_castsi256_ps(e1)) << 8
+                                    | (unsigned)_mm256_movemask_ps(_mm256_castsi256_ps(e2)) << 16
+                                    | (unsigned long long)(unsigned)_mm256_movemask_ps(_mm256_castsi256_ps(e3)) << 24;
+            return i + __builtin_ctzll(mask);
+        }
+    }
+    return i + scalarFindFirst(data + i, n - i, value);
+}
+
+static size_t avx2Count(const int* data, size_t n, int value) {
+    const __m256i needle = _mm256_set1_epi32(value);
+    size_t count = 0, i = 0;
+    for (; i + 32 <= n; i += 32) {
+        unsigned long long mask = (unsigned)_mm256_movemask_ps(_mm256_castsi256_ps(
+                                      _mm256_cmpeq_epi32(_mm256_loadu_si256((const __m256i*)(data + i)), needle)))
+                                | (unsigned)_mm256_movemask_ps(_mm256_castsi256_ps(
+                                      _mm256_cmpeq_epi32(_mm256_loadu_si256((const __m256i*)(data + i + 8)), needle))) << 8
+                                | (unsigned)_mm256_movemask_ps(_mm256_castsi256_ps(
+                                      _mm256_cmpeq_epi32(_mm256_loadu_si256((const __m256i*)(data + i + 16)), needle))) << 16
+                                | (unsigned long long)(unsigned)_mm256_movemask_ps(_mm256_castsi256_ps(
+                                      _mm256_cmpeq_epi32(_mm256_loadu_si256((const __m256i*)(data + i + 24)), needle))) << 24;
+        count += __builtin_popcountll(mask);
+    }
+    return count + scalarCount(data + i, n - i, value);
+}
+
+#pragma GCC pop_options
+
+#pragma GCC push_options
+#pragma GCC target("avx512f,popcnt")
+
+static size_t avx512FindFirst(const int* data, size_t n, int value) {
+    const __m512i needle = _mm512_set1_epi32(value);
+    size_t i = 0;
+    for (; i + 64 <= n; i += 64) {
+        __mmask16 m0 = _mm512_cmpeq_epi32_mask(_mm512_loadu_si512(data + i), needle);
+        __mmask16 m1 = _mm512_cmpeq_epi32_mask(_mm512_loadu_si512(data + i + 16), needle);
+        __mmask16 m2 = _mm512_cmpeq_epi32_mask(_mm512_loadu_si512(data + i + 32), needle);
+        __mmask16 m3 = _mm512_cmpeq_epi32_mask(_mm512_loadu_si512(data + i + 48), needle);
+        if (m0 | m1 | m2 | m3) {
+            unsigned long long mask = (unsigned long long)m0 | (unsigned long long)m1 << 16
+                                    | (unsigned long long)m2 << 32 | (unsigned long long)m3 << 48;
+            return i + __builtin_ctzll(mask);
+        }
+    }
+    return i + scalarFindFirst(data + i, n - i, value);
+}
+
+static size_t avx512Count(const int* data, size_t n, int value) {
+    const __m512i needle = _mm512_set1_epi32(value);
+    size_t count = 0, i = 0;
+    for (; i + 64 <= n; i += 64) {
+        unsigned long long mask = (unsigned long long)_mm512_cmpeq_epi32_mask(_mm512_loadu_si512(data + i), needle)
+                                | (unsigned long long)_mm512_cmpeq_epi32_mask(_mm512_loadu_si512(data + i + 16), needle) << 16
+                                | (unsigned long long)_mm512_cmpeq_epi32_mask(_mm512_loadu_si512(data + i + 32), needle) << 32
+                                | (unsigned long long)_mm512_cmpeq_epi32_mask(_mm512_loadu_si512(data + i + 48), needle) << 48;
+        count += __builtin_popcountll(mask);
+    }
+    return count + scalarCount(data + i, n - i, value);
+}
+
+#pragma GCC pop_options
+
+#endif
+
+static const ScanKernelOps& selectScanKernel() {
+    static const ScanKernelOps scalar_ops = {"scalar", scalarFindFirst, scalarCount};
+#ifdef SCAN_X86_KERNELS
+    static const ScanKernelOps avx2_ops = {"AVX2", avx2FindFirst, avx2Count};
+    static const ScanKernelOps avx512_ops = {"AVX-512", avx512FindFirst, avx512Count};
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f"))
+        return avx512_ops;
+    if (__builtin_cpu_supports("avx2"))
+        return avx2_ops;
+#endif
+    return scalar_ops;
+}
+
+static const ScanKernelOps& scanKernel() {
+    static const ScanKernelOps& ops = selectScanKernel();
+    return ops;
+}
+
+const char* scanKernelName() {
+    return scanKernel().name;
+}
+
+size_t scanFirstEqual(const int* data, size_t n, int value) {
+    return scanKernel().find_first(data, n, value);
+}
+
+size_t scanCountEqual(const int* data, size_t n, int value) {
+    return scanKernel().count(data, n, value);
+}
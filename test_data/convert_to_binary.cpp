@@ -0,0 +1,70 @@
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <cstring>
+
+using namespace std;
+
+// Output layout matches readBinaryFileDistributed(): "PCDB", uint32 element width, uint64 count, elements.
+template <typename T>
+int writeBinaryFile(const string& input_filename, const string& output_filename) {
+    ifstream infile(input_filename);
+    if (!infile) {
+        cerr << "Error opening file: " << input_filename << endl;
+        return 1;
+    }
+
+    vector<T> data;
+    T num;
+    while (infile >> num) {
+        data.push_back(num);
+    }
+    infile.close();
+
+    ofstream outfile(output_filename, ios::binary);
+    if (!outfile.is_open()) {
+        cerr << "Error opening file: " << output_filename << endl;
+        return 1;
+    }
+
+    unsigned int element_bytes = sizeof(T);
+    unsigned long long element_count = data.size();
+    outfile.write("PCDB", 4);
+    outfile.write(reinterpret_cast<const char*>(&element_bytes), sizeof(element_bytes));
+    outfile.write(reinterpret_cast<const char*>(&element_count), sizeof(element_count));
+    outfile.write(reinterpret_cast<const char*>(data.data()), data.size() * sizeof(T));
+    outfile.close();
+
+    cout << "Successfully converted " << element_count << " elements into " << output_filename << endl;
+    return 0;
+}
+
+int main() {
+    string input_filename;
+    string output_filename;
+    int element_bytes;
+
+    cout << "Enter the input text filename: ";
+    getline(cin, input_filename);
+
+    string default_filename = input_filename + ".bin";
+    size_t dot = input_filename.rfind('.');
+    if (dot != string::npos && input_filename.substr(dot) == ".txt") {
+        default_filename = input_filename.substr(0, dot) + ".bin";
+    }
+
+    cout << "Enter output filename (default: " << default_filename << "): ";
+    getline(cin, output_filename);
+    if (output_filename.empty()) {
+        output_filename = default_filename;
+    }
+
+    cout << "Enter the element width in bytes (4 for int32, 8 for int64): ";
+    cin >> element_bytes;
+
+    if (element_bytes == 8) {
+        return writeBinaryFile<long long>(input_filename, output_filename);
+    }
+    return writeBinaryFile<int>(input_filename, output_filename);
+}
@@ -4,13 +4,15 @@
 echo "Compiling data generators..."
 g++ -o generate_power_of_two_data.o generate_power_of_two_data.cpp
 g++ -o generate_general_data.o generate_general_data.cpp
+g++ -o convert_to_binary.o convert_to_binary.cpp
 
 echo ""
 echo "===== TEST DATA GENERATOR ====="
 echo "1. Generate power-of-two data for Bitonic Sort"
 echo "2. Generate data for other algorithms"
+echo "3. Convert a text data file to the binary input format"
 echo "============================="
-echo "Enter your choice (1-2): "
+echo "Enter your choice (1-3): "
 read choice
 
 case $choice in
@@ -22,6 +24,10 @@ case $choice in
         echo "Running general data generator for other algorithms..."
         ./generate_general_data.o
         ;;
+    3)
+        echo "Running text-to-binary converter..."
+        ./convert_to_binary.o
+        ;;
     *)
         echo "Invalid choice"
         ;;